@@ -0,0 +1,311 @@
+#include "../core.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+// Bytes requested through operator new by the whole process, for the memory-per-queued-task benchmark.
+// Blocks stay plain malloc blocks, so memory allocated or freed inside the Qt libraries still matches.
+namespace {
+
+std::atomic<qint64> g_allocatedHeapBytes{0};
+
+void* countedAllocate(std::size_t size) {
+    void* pointer = std::malloc(size ? size : 1);
+    if (!pointer) {
+        throw std::bad_alloc();
+    }
+    g_allocatedHeapBytes.fetch_add(static_cast<qint64>(size), std::memory_order_relaxed);
+    return pointer;
+}
+
+} // namespace
+
+void* operator new(std::size_t size) { return countedAllocate(size); }
+void* operator new[](std::size_t size) { return countedAllocate(size); }
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { std::free(pointer); }
+
+namespace {
+
+constexpr TaskType kEmptyTaskType = 1;
+constexpr TaskType kBlockerTaskType = 2;
+constexpr TaskType kQueuedTaskType = 3;
+constexpr TaskGroup kBlockedGroup = 1;
+constexpr int kGroupTaskTypeBase = 100; // one empty task type per group in the throughput runs
+constexpr int kWaitTimeoutMs = 120000;
+
+const Core::ExecutionMode kModes[] = {Core::ExecutionMode::DedicatedThreads, Core::ExecutionMode::WorkerPool};
+
+QString modeName(Core::ExecutionMode mode) {
+    return mode == Core::ExecutionMode::WorkerPool ? QStringLiteral("WorkerPool") : QStringLiteral("DedicatedThreads");
+}
+
+struct BenchmarkConfig {
+    int latencySamples = 2000;
+    QVector<int> groupCounts{1, 4, 16};
+    QVector<int> queueDepths{64, 1024, 8192};
+};
+
+class BenchmarkReport {
+public:
+    void add(const QString& name, Core::ExecutionMode mode, const QJsonObject& parameters, const QJsonObject& metrics) {
+        QJsonObject result;
+        result.insert(QStringLiteral("name"), name);
+        result.insert(QStringLiteral("mode"), modeName(mode));
+        result.insert(QStringLiteral("parameters"), parameters);
+        result.insert(QStringLiteral("metrics"), metrics);
+        m_results.append(result);
+        QTextStream(stderr) << name << " [" << modeName(mode) << "] "
+                            << QJsonDocument(parameters).toJson(QJsonDocument::Compact) << " -> "
+                            << QJsonDocument(metrics).toJson(QJsonDocument::Compact) << '\n';
+    }
+
+    QByteArray toJson(bool quick) const {
+        QJsonObject root;
+        root.insert(QStringLiteral("schema"), 1);
+        root.insert(QStringLiteral("suite"), QStringLiteral("CoreTemplateBenchmarks"));
+        root.insert(QStringLiteral("qtVersion"), QString::fromLatin1(qVersion()));
+        root.insert(QStringLiteral("idealThreadCount"), QThread::idealThreadCount());
+        root.insert(QStringLiteral("quick"), quick);
+        root.insert(QStringLiteral("results"), m_results);
+        return QJsonDocument(root).toJson(QJsonDocument::Indented);
+    }
+
+private:
+    QJsonArray m_results;
+};
+
+// Runs the event loop until done() holds; the Core delivers its signals through it.
+template <typename Predicate>
+bool waitUntil(Predicate done) {
+    QElapsedTimer timer;
+    timer.start();
+    while (!done()) {
+        if (timer.elapsed() > kWaitTimeoutMs) {
+            qWarning() << "CoreTemplateBenchmarks - Timed out waiting for tasks";
+            return false;
+        }
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    }
+    return true;
+}
+
+qint64 percentile(const std::vector<qint64>& sorted, double fraction) {
+    const std::size_t index = std::min(sorted.size() - 1, static_cast<std::size_t>(fraction * static_cast<double>(sorted.size())));
+    return sorted[index];
+}
+
+// One empty task at a time: addTask until its finishedTask reaches the owner thread.
+void benchmarkSubmitToFinishLatency(BenchmarkReport& report, Core::ExecutionMode mode, const BenchmarkConfig& config) {
+    Core core;
+    if (!core.setExecutionMode(mode)) {
+        return;
+    }
+    core.registerTask(kEmptyTaskType, []() -> int { return 0; });
+
+    std::vector<qint64> latenciesNs;
+    latenciesNs.reserve(static_cast<std::size_t>(config.latencySamples));
+    QElapsedTimer clock;
+    clock.start();
+    qint64 submittedNs = 0;
+    QObject::connect(&core, &Core::finishedTask, &core, [&]() {
+        latenciesNs.push_back(clock.nsecsElapsed() - submittedNs);
+    });
+
+    for (int sample = 0; sample < config.latencySamples; ++sample) {
+        const std::size_t expected = latenciesNs.size() + 1;
+        submittedNs = clock.nsecsElapsed();
+        core.addTask(kEmptyTaskType);
+        if (!waitUntil([&]() { return latenciesNs.size() == expected; })) {
+            return;
+        }
+    }
+
+    std::sort(latenciesNs.begin(), latenciesNs.end());
+    qint64 totalNs = 0;
+    for (qint64 latencyNs : latenciesNs) {
+        totalNs += latencyNs;
+    }
+    report.add(QStringLiteral("submit_to_finish_latency"), mode,
+               {{QStringLiteral("samples"), config.latencySamples}},
+               {{QStringLiteral("meanNs"), static_cast<double>(totalNs) / static_cast<double>(latenciesNs.size())},
+                {QStringLiteral("p50Ns"), percentile(latenciesNs, 0.50)},
+                {QStringLiteral("p90Ns"), percentile(latenciesNs, 0.90)},
+                {QStringLiteral("p99Ns"), percentile(latenciesNs, 0.99)},
+                {QStringLiteral("maxNs"), latenciesNs.back()}});
+}
+
+// queueDepth empty tasks per group, submitted up front; groups run in parallel, each one task at a time.
+void benchmarkThroughput(BenchmarkReport& report, Core::ExecutionMode mode, int groupCount, int queueDepth) {
+    Core core;
+    if (!core.setExecutionMode(mode)) {
+        return;
+    }
+    for (int group = 1; group <= groupCount; ++group) {
+        core.registerTask(kGroupTaskTypeBase + group, []() -> int { return 0; }, group);
+    }
+
+    const int totalTasks = groupCount * queueDepth;
+    int finished = 0;
+    QObject::connect(&core, &Core::finishedTask, &core, [&finished]() { ++finished; });
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int index = 0; index < queueDepth; ++index) {
+        for (int group = 1; group <= groupCount; ++group) {
+            core.addTask(kGroupTaskTypeBase + group);
+        }
+    }
+    const qint64 submitNs = timer.nsecsElapsed();
+    if (!waitUntil([&]() { return finished == totalTasks; })) {
+        return;
+    }
+    const qint64 totalNs = timer.nsecsElapsed();
+
+    report.add(QStringLiteral("throughput"), mode,
+               {{QStringLiteral("groups"), groupCount}, {QStringLiteral("queueDepth"), queueDepth}},
+               {{QStringLiteral("tasksPerSecond"), static_cast<double>(totalTasks) * 1e9 / static_cast<double>(totalNs)},
+                {QStringLiteral("submitNsPerTask"), static_cast<double>(submitNs) / totalTasks},
+                {QStringLiteral("totalMs"), static_cast<double>(totalNs) / 1e6}});
+}
+
+// Occupies kBlockedGroup with a task that runs until it is stopped, so everything added after it queues.
+bool startBlocker(Core& core) {
+    core.registerTask(kBlockerTaskType, [&core]() -> int {
+        for (;;) {
+            if (auto* stop = core.stopTaskFlag(); stop && stop->load()) {
+                return 0;
+            }
+            QThread::msleep(1);
+        }
+    }, kBlockedGroup);
+    core.registerTask(kQueuedTaskType, [](int value) -> int { return value; }, kBlockedGroup);
+
+    bool started = false;
+    const auto connection = QObject::connect(&core, &Core::startedTask, &core, [&started]() { started = true; });
+    core.addTask(kBlockerTaskType);
+    const bool ok = waitUntil([&]() { return started; });
+    QObject::disconnect(connection);
+    return ok;
+}
+
+// stopTasksByGroup over a full queue: the call itself, and until every task is reported back.
+void benchmarkBatchCancellation(BenchmarkReport& report, Core::ExecutionMode mode, int queueDepth) {
+    Core core;
+    if (!core.setExecutionMode(mode) || !startBlocker(core)) {
+        return;
+    }
+    for (int index = 0; index < queueDepth; ++index) {
+        core.addTask(kQueuedTaskType, index);
+    }
+
+    int reported = 0;
+    QObject::connect(&core, &Core::terminatedTask, &core, [&reported]() { ++reported; });
+    QObject::connect(&core, &Core::finishedTask, &core, [&reported]() { ++reported; });
+
+    QElapsedTimer timer;
+    timer.start();
+    core.stopTasksByGroup(kBlockedGroup, true);
+    const qint64 callNs = timer.nsecsElapsed();
+    if (!waitUntil([&]() { return reported == queueDepth + 1; })) {
+        return;
+    }
+    const qint64 drainNs = timer.nsecsElapsed();
+
+    report.add(QStringLiteral("batch_cancellation"), mode,
+               {{QStringLiteral("queueDepth"), queueDepth}},
+               {{QStringLiteral("callNs"), callNs},
+                {QStringLiteral("callNsPerQueuedTask"), static_cast<double>(callNs) / queueDepth},
+                {QStringLiteral("drainMs"), static_cast<double>(drainNs) / 1e6}});
+}
+
+// Heap bytes allocated while adding queueDepth tasks with one int argument behind the blocker;
+// includes short-lived allocations made on the way into the queue.
+void benchmarkQueuedTaskMemory(BenchmarkReport& report, Core::ExecutionMode mode, int queueDepth) {
+    Core core;
+    if (!core.setExecutionMode(mode) || !startBlocker(core)) {
+        return;
+    }
+
+    const qint64 bytesBefore = g_allocatedHeapBytes.load();
+    for (int index = 0; index < queueDepth; ++index) {
+        core.addTask(kQueuedTaskType, index);
+    }
+    const qint64 bytesAfter = g_allocatedHeapBytes.load();
+
+    int reported = 0;
+    QObject::connect(&core, &Core::terminatedTask, &core, [&reported]() { ++reported; });
+    QObject::connect(&core, &Core::finishedTask, &core, [&reported]() { ++reported; });
+    core.stopTasksByGroup(kBlockedGroup, true);
+    waitUntil([&]() { return reported == queueDepth + 1; });
+
+    report.add(QStringLiteral("queued_task_memory"), mode,
+               {{QStringLiteral("queueDepth"), queueDepth}},
+               {{QStringLiteral("allocatedBytesPerQueuedTask"), static_cast<double>(bytesAfter - bytesBefore) / queueDepth}});
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("CoreTemplate scheduler microbenchmarks"));
+    parser.addHelpOption();
+    const QCommandLineOption quickOption(QStringLiteral("quick"), QStringLiteral("Fewer samples and smaller queues, for CI smoke runs."));
+    const QCommandLineOption outputOption(QStringList{QStringLiteral("o"), QStringLiteral("output")},
+                                          QStringLiteral("Write the JSON results to <file> instead of stdout."), QStringLiteral("file"));
+    parser.addOption(quickOption);
+    parser.addOption(outputOption);
+    parser.process(app);
+
+    BenchmarkConfig config;
+    const bool quick = parser.isSet(quickOption);
+    if (quick) {
+        config.latencySamples = 200;
+        config.groupCounts = {1, 4};
+        config.queueDepths = {64, 512};
+    }
+
+    BenchmarkReport report;
+    for (Core::ExecutionMode mode : kModes) {
+        benchmarkSubmitToFinishLatency(report, mode, config);
+        for (int groupCount : std::as_const(config.groupCounts)) {
+            for (int queueDepth : std::as_const(config.queueDepths)) {
+                benchmarkThroughput(report, mode, groupCount, queueDepth);
+            }
+        }
+        for (int queueDepth : std::as_const(config.queueDepths)) {
+            benchmarkBatchCancellation(report, mode, queueDepth);
+            benchmarkQueuedTaskMemory(report, mode, queueDepth);
+        }
+    }
+
+    const QByteArray json = report.toJson(quick);
+    if (parser.isSet(outputOption)) {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qWarning() << "CoreTemplateBenchmarks - Cannot write" << file.fileName();
+            return 1;
+        }
+        file.write(json);
+    } else {
+        QTextStream(stdout) << json;
+    }
+    return 0;
+}
@@ -0,0 +1,11 @@
+TEMPLATE = app
+TARGET = CoreTemplateBenchmarks
+
+CONFIG += console c++17
+CONFIG -= app_bundle
+QT += core
+QT -= gui
+
+SOURCES += core_benchmarks.cpp
+HEADERS += ../core.h
+INCLUDEPATH += ..
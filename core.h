@@ -13,20 +13,54 @@
 #include <algorithm>
 #include <utility>
 #include <stdexcept>
+#include <tuple>
+#include <optional>
+#include <variant>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <queue>
+#include <array>
+#include <chrono>
+#include <limits>
+#include <cmath>
+#include <cerrno>
 
 // --- Import Qt headers ---
 #include <QObject>
+#include <QPointer>
 #include <QVariant>
 #include <QList>
 #include <QSharedPointer>
 #include <QHash>
+#include <QMap>
+#include <QCache>
+#include <QDataStream>
+#include <QVector>
 #include <QMetaType>
+#include <QMetaMethod>
 #include <QDebug>
 #include <QTimer>
 #include <QElapsedTimer>
+#include <QDeadlineTimer>
 #include <QThread>
+#include <QFile>
+#include <QSaveFile>
+#include <QtEndian>
 #include <QCoreApplication>
 #include <QEventLoop>
+#include <QAbstractEventDispatcher>
+#include <QSocketNotifier>
+
+// --- C++20 coroutine support for TaskHandle (co_await) when the compiler provides it ---
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+    #if __has_include(<coroutine>)
+        #include <coroutine>
+        #define CORE_HAS_COROUTINES 1
+    #endif
+#endif
 
 // --- Threading/Multiprocessing API Headers ---
 #ifdef Q_OS_WIN
@@ -34,6 +68,8 @@
 #else
     #include <pthread.h>
     #include <signal.h>
+    #include <unistd.h>
+    #include <fcntl.h>
 #endif
 
 // --- Using aliases to improve readability ---
@@ -41,13 +77,104 @@ using TaskId = long;
 using TaskType = int;
 using TaskGroup = int;
 using TaskStopTimeout = int; // ms
+using TaskPriority = int;   // higher runs first within a group
 
 namespace core_detail {
 inline thread_local std::atomic_bool* g_currentStopFlag = nullptr;
+
+// Node of a cancellation tree: it counts as canceled once it or any ancestor is. cancel() runs on the
+// canceling thread and sets the stop flag of every task started with the node or one of its descendants,
+// so tasks that read stopTaskFlag() once and keep polling it see the cancellation.
+struct CancellationNode {
+    explicit CancellationNode(QSharedPointer<CancellationNode> pParent = {})
+        : m_pParent(std::move(pParent)) {}
+
+    bool isCanceled() const {
+        for (const CancellationNode* pNode = this; pNode != nullptr; pNode = pNode->m_pParent.data()) {
+            if (pNode->m_canceled.load()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Locks go parent before child, the same order as addChild, so concurrent cancels cannot deadlock.
+    void cancel() {
+        m_canceled.store(true);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (std::atomic_bool* pStopFlag : m_stopFlags) {
+            pStopFlag->store(true);
+        }
+        for (const QWeakPointer<CancellationNode>& pWeakChild : m_children) {
+            if (QSharedPointer<CancellationNode> pChild = pWeakChild.toStrongRef()) {
+                pChild->cancel();
+            }
+        }
+    }
+
+    void addChild(const QSharedPointer<CancellationNode>& pChild) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // Children die with their tokens; expired entries are pruned whenever the list doubles.
+        if (m_children.size() >= m_childrenPruneSize) {
+            m_children.erase(std::remove_if(m_children.begin(), m_children.end(),
+                                            [](const QWeakPointer<CancellationNode>& pChild) { return pChild.isNull(); }),
+                             m_children.end());
+            m_childrenPruneSize = std::max<std::size_t>(kInitialChildrenPruneSize, m_children.size() * 2);
+        }
+        m_children.push_back(pChild);
+    }
+
+    // The flag is set right away if the node is already canceled. A cancel() racing with this call
+    // either finds the flag in the list or its store is seen by the isCanceled() check that follows.
+    void registerStopFlag(std::atomic_bool* pStopFlag) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopFlags.push_back(pStopFlag);
+        }
+        if (isCanceled()) {
+            pStopFlag->store(true);
+        }
+    }
+
+    void unregisterStopFlag(std::atomic_bool* pStopFlag) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = std::find(m_stopFlags.begin(), m_stopFlags.end(), pStopFlag);
+        if (it != m_stopFlags.end()) {
+            *it = m_stopFlags.back();
+            m_stopFlags.pop_back();
+        }
+    }
+
+    static constexpr std::size_t kInitialChildrenPruneSize = 8;
+
+    std::atomic_bool m_canceled{false};
+    const QSharedPointer<CancellationNode> m_pParent;
+    std::mutex m_mutex;
+    std::vector<std::atomic_bool*> m_stopFlags; // of the running tasks added with this token
+    std::vector<QWeakPointer<CancellationNode>> m_children;
+    std::size_t m_childrenPruneSize = kInitialChildrenPruneSize;
+};
+
+// Lets Core cancel and chain TaskHandle states without knowing their result types.
+struct TaskHandleStateBase {
+    virtual ~TaskHandleStateBase() = default;
+    virtual void cancel() = 0;
+    // The callback gets true if the task delivered its result and false if it was canceled.
+    virtual void onDone(std::function<void(bool finished)> callback) = 0;
+};
 }
 
 // --- Declaring constants ---
 inline constexpr TaskStopTimeout kDefaultStopTimeout = 1000;
+inline constexpr int kDefaultGroupConcurrency = 1;  // groups are exclusive unless configured otherwise
+inline constexpr int kUnlimitedGroupConcurrency = 0;
+inline constexpr double kUnlimitedGroupRate = 0.0; // tasks per second
+inline constexpr int kDefaultShutdownTimeout = 2000; // ms the destructor waits for cooperative stop
+inline constexpr TaskPriority kDefaultTaskPriority = 0;
+inline constexpr int kDefaultPriorityAging = 32; // queued tasks one priority level may overtake
+inline constexpr int kDefaultChannelCapacity = 64; // rounded up to a power of two
+inline constexpr int kDefaultTraceEventCapacity = 65536; // shared by all threads; oldest events are overwritten
+inline constexpr int kDefaultWorkerIdleTimeout = 10000; // ms an adaptive pool keeps a surplus worker idle
 
 // --- Templates for checking convertibility ---
 template<typename T>
@@ -87,13 +214,50 @@ auto bind_placeholders(R (Class::*taskFunction)(Args...) const, Class* taskObj,
     return std::bind(taskFunction, taskObj, placeholder<N + 1>()...);
 }
 
+namespace core_detail {
+// Wakes a Core destructor that waits for tasks without an event dispatcher. While nobody waits, a task
+// end costs one atomic load.
+struct TaskExitSignal {
+    void notify() {
+        if (m_waiters.load() == 0) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_exits;
+        }
+        m_condition.notify_all();
+    }
+
+    std::atomic_int m_waiters{0};
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    quint64 m_exits = 0;
+};
+}
+
 // --- Classes ---
+class TaskCompletionQueue;
+class TaskThreadExitQueue;
+
 class TaskHelper final : public QObject {
     Q_OBJECT
 
 public:
+    explicit TaskHelper(QObject* parent = nullptr);
     explicit TaskHelper(std::function<QVariant()> function, std::atomic_bool* pStopFlag, std::atomic_bool* pThreadExited, QObject* parent = nullptr);
 
+    TaskHelper(int slotIndex, core_detail::TaskExitSignal* pExitSignal, QObject* parent);
+
+    // Rebinds an idle helper to the next task, so one helper (and its connection) serves many tasks.
+    // With a completion queue the result is pushed there instead of being emitted through finished.
+    // The helper is pushed to pThreadExitQueue if its thread is torn down before the task returns (pthread_cancel).
+    void bind(std::function<QVariant()> function, std::atomic_bool* pStopFlag, std::atomic_bool* pThreadExited,
+              TaskCompletionQueue* pCompletionQueue = nullptr, TaskThreadExitQueue* pThreadExitQueue = nullptr);
+
+    int slotIndex() const;
+    QVariant takeResult();
+
 #ifdef Q_OS_WIN
     static DWORD WINAPI functionWrapper(void* pTaskHelper);
 #else
@@ -101,11 +265,22 @@ public:
     static void cleanupThreadExit(void* pTaskHelper) noexcept;
 #endif
 
+    void execute(); // Runs the bound function in the calling thread (dedicated task thread or pool worker)
+
 private:
+    friend class TaskCompletionQueue;
+    friend class TaskThreadExitQueue;
+
     std::function<QVariant()> m_function;
     std::atomic_bool* m_pStopFlag = nullptr;
     std::atomic_bool* m_pThreadExited = nullptr;
-    void execute(); // Method declaration
+    TaskCompletionQueue* m_pCompletionQueue = nullptr;
+    TaskThreadExitQueue* m_pThreadExitQueue = nullptr;
+    int m_slotIndex = -1;
+    core_detail::TaskExitSignal* m_pExitSignal = nullptr; // fixed for the life of the helper
+    QVariant m_result;                       // handed over through m_pCompletionQueue
+    TaskHelper* m_pNextCompleted = nullptr;  // intrusive link inside m_pCompletionQueue
+    TaskHelper* m_pNextExited = nullptr;     // intrusive link inside m_pThreadExitQueue
     void markThreadExited() noexcept;
 
 signals:
@@ -113,917 +288,5346 @@ signals:
 };
 
 /**
- * @brief The Core class manages task execution in separate threads.
+ * @brief Lock-free multi-producer/single-consumer list of TaskHelpers whose task has finished.
  *
- * IMPORTANT: All public methods of this class (e.g., addTask, stopTaskById, etc.)
- * must be called from the same thread where the Core object lives (typically the main GUI thread).
- * Calling these methods from task threads concurrently may lead to undefined behavior.
+ * Task threads push their helper (the helper itself is the list node, so nothing is allocated);
+ * the owner thread takes the whole list with one exchange. Only the push that finds the list
+ * empty calls the notifier, so a burst of completions costs a single cross-thread wake-up.
  */
-class Core : public QObject {
-    Q_OBJECT
-
+class TaskCompletionQueue final {
 public:
-    explicit Core(QObject* parent = nullptr);
-    ~Core() override;
-
-    template <typename R, typename... Args>
-    void registerTask(TaskType taskType, std::function<R(Args...)> taskFunction, TaskGroup taskGroup = 0, TaskStopTimeout taskStopTimeout = kDefaultStopTimeout);
-
-    template <typename R, typename... Args>
-    void registerTask(TaskType taskType, R (*taskFunction)(Args...), TaskGroup taskGroup = 0, TaskStopTimeout taskStopTimeout = kDefaultStopTimeout);
+    explicit TaskCompletionQueue(std::function<void()> notifier);
 
-    template <typename Class, typename R, typename... Args>
-    void registerTask(TaskType taskType, R (Class::*taskMethod)(Args...), Class* taskObj, TaskGroup taskGroup = 0, TaskStopTimeout taskStopTimeout = kDefaultStopTimeout);
+    TaskCompletionQueue(const TaskCompletionQueue&) = delete;
+    TaskCompletionQueue& operator=(const TaskCompletionQueue&) = delete;
 
-    template <typename Class, typename R, typename... Args>
-    void registerTask(TaskType taskType, R (Class::*taskMethod)(Args...) const, Class* taskObj, TaskGroup taskGroup = 0, TaskStopTimeout taskStopTimeout = kDefaultStopTimeout);
+    void push(TaskHelper* pHelper) noexcept;
+    QVector<TaskHelper*> takeAll(); // oldest first
 
-    // More generic overload (for lambdas, functors, results of std::bind)
-    template <typename F>
-    void registerTask(TaskType taskType, F&& taskFunction, TaskGroup taskGroup = 0, TaskStopTimeout taskStopTimeout = kDefaultStopTimeout);
+private:
+    std::atomic<TaskHelper*> m_pHead{nullptr};
+    std::function<void()> m_notifier;
+};
 
-    bool unregisterTask(TaskType taskType);
+#ifndef Q_OS_WIN
+/**
+ * @brief Lock-free list of TaskHelpers whose dedicated thread was canceled before its task returned.
+ *
+ * push() runs in the cleanup handler of an asynchronously canceled thread, where only async-signal-safe
+ * calls are allowed: it is a CAS on the list head and, when the list was empty, a one-byte write() to a
+ * non-blocking pipe. The owner thread watches the read end with a QSocketNotifier.
+ */
+class TaskThreadExitQueue final {
+public:
+    TaskThreadExitQueue() = default;
+    ~TaskThreadExitQueue();
 
-    template <typename... Args>
-    void addTask(TaskType taskType, Args... args);
+    TaskThreadExitQueue(const TaskThreadExitQueue&) = delete;
+    TaskThreadExitQueue& operator=(const TaskThreadExitQueue&) = delete;
 
-    std::atomic_bool* stopTaskFlag();
-    void cancelTaskById(TaskId id);
-    void cancelTaskByType(TaskType type);
-    void cancelTaskByGroup(TaskGroup group);
-    void cancelTasks();
-    void cancelAllTasks();
-    void cancelTasksByGroup(TaskGroup group, bool includeQueued);
-    void terminateTaskById(TaskId id);
-    void setAllowForceTermination(bool allow);
-    bool allowForceTermination() const;
-    void stopTaskById(TaskId id);
-    void stopTaskByType(TaskType type);
-    void stopTaskByGroup(TaskGroup group);
-    void stopTasks();
-    void stopAllTasks();
-    void stopTasksByGroup(TaskGroup group, bool includeQueued);
-    bool isTaskRegistered(TaskType type);
-    TaskGroup groupByTask(TaskType type, bool* ok = nullptr);
-    bool isIdle();
-    bool isTaskAddedByType(TaskType type, bool* isActive = nullptr);
-    bool isTaskAddedByGroup(TaskGroup group, bool* isActive = nullptr);
+    bool open(); // creates the pipe once; false if that failed
+    int readDescriptor() const;
+    void push(TaskHelper* pHelper) noexcept;
+    QVector<TaskHelper*> takeAll(); // oldest first; also empties the pipe
 
 private:
-    enum class TaskState {
-        Inactive,
-        Active,
-        StopRequested,
-        StopTimedOut,
-        Finished,
-        Terminated
-    };
+    std::atomic<TaskHelper*> m_pHead{nullptr};
+    int m_pipe[2] = {-1, -1};
+};
+#endif
 
-    struct TaskInfo {
-        std::any m_function;
-        TaskGroup m_group;
-        TaskStopTimeout m_stopTimeout;
-    };
+// Lock-free MPSC list of commands posted from any thread and drained on the owner thread.
+// Like TaskCompletionQueue, the notifier runs only when the list was empty.
+class TaskSubmissionQueue final {
+public:
+    explicit TaskSubmissionQueue(std::function<void()> notifier);
+    ~TaskSubmissionQueue();
 
-    struct Task {
-        Task(std::function<QVariant()> functionBound, TaskType type, TaskGroup group, QList<QVariant> argsList = {})
-            : m_functionBound(std::move(functionBound))
-            , m_type(type)
-            , m_group(group)
-            , m_argsList(std::move(argsList))
-            , m_state(TaskState::Inactive) {
+    TaskSubmissionQueue(const TaskSubmissionQueue&) = delete;
+    TaskSubmissionQueue& operator=(const TaskSubmissionQueue&) = delete;
 
-            static TaskId id_counter = 0;
-            m_id = id_counter++; // m_id cannot be initialized in the list, because it depends on the counter
-        }
+    void push(std::function<void()> command);
+    std::vector<std::function<void()>> takeAll(); // oldest first
 
-        TaskId m_id;
-        std::function<QVariant()> m_functionBound;
-        TaskType m_type;
-        TaskGroup m_group;
-        QList<QVariant> m_argsList;
-    #ifdef Q_OS_WIN
-        HANDLE m_threadHandle = nullptr;
-        DWORD m_threadId = 0;
-    #else
-        pthread_t m_threadHandle = 0;
-    #endif
-        std::atomic_bool m_stopFlag{false};
-        std::atomic_bool m_threadExited{false};
-        TaskState m_state;
+private:
+    struct Node {
+        std::function<void()> m_command;
+        Node* m_pNext = nullptr;
     };
 
-    QSharedPointer<Task> activeTaskById(TaskId id);
-    QSharedPointer<Task> activeTaskByType(TaskType type);
-    QSharedPointer<Task> activeTaskByGroup(TaskGroup group);
-
-    void terminateTask(QSharedPointer<Task> pTask);
-    void stopTask(QSharedPointer<Task> pTask);
-    void startTask(QSharedPointer<Task> pTask);
-    void startQueuedTask();
-    bool ensureCalledFromOwnerThread(const char* method) const;
-
-    template <typename... Args>
-    void insertToTaskHash(TaskType taskType, std::function<QVariant(Args...)> taskFunction, TaskGroup taskGroup = 0, TaskStopTimeout taskStopTimeout = kDefaultStopTimeout);
+    Node* detachAll();
 
-    QHash<TaskType, TaskInfo> m_taskHash;
-    QList<QSharedPointer<Task>> m_activeTaskList;
-    QList<QSharedPointer<Task>> m_queuedTaskList;
-    std::atomic_bool m_blockStartTask{false};
-    bool m_allowForceTermination = false;
+    std::atomic<Node*> m_pHead{nullptr};
+    std::function<void()> m_notifier;
+};
 
-signals:
-    void finishedTask(TaskId id, TaskType type, QList<QVariant> argsList = {}, QVariant result = QVariant());
-    void startedTask(TaskId id, TaskType type, QList<QVariant> argsList = {});
-    void terminatedTask(TaskId id, TaskType type, QList<QVariant> argsList = {});
-    void stopRequestedTask(TaskId id, TaskType type, QList<QVariant> argsList = {});
-    void stopTimedOutTask(TaskId id, TaskType type, QList<QVariant> argsList = {}, TaskStopTimeout timeout = kDefaultStopTimeout);
+/**
+ * @brief Attributes of the threads that run the tasks of one group (see Core::setGroupThreadPolicy).
+ *
+ * Fields left at their defaults keep the platform defaults. CPU affinity and NUMA placement are applied
+ * on Linux and Windows only; a NUMA node is turned into the CPUs of that node, so memory the tasks touch
+ * first is allocated there.
+ */
+struct TaskThreadPolicy {
+    QVector<int> cpuAffinity;          // logical CPUs the threads may run on; empty = no restriction
+    int numaNode = -1;                 // -1 = any node; intersected with cpuAffinity when both are set
+    std::size_t stackSize = 0;         // bytes; 0 = platform default
+    QThread::Priority priority = QThread::InheritPriority;
+    QString threadName;                // Linux keeps the first 15 bytes
+    int dedicatedWorkers = 0;          // WorkerPool mode: the group runs on this many workers of its own
+
+    bool isDefault() const {
+        return cpuAffinity.isEmpty() && numaNode < 0 && stackSize == 0 && priority == QThread::InheritPriority
+            && threadName.isEmpty() && dedicatedWorkers == 0;
+    }
 };
 
-// --- Class method implementations *after* class declarations ---
+/**
+ * @brief Fixed set of persistent worker threads used by Core in the WorkerPool execution mode.
+ *
+ * Every worker owns a deque of ready jobs. Jobs submitted from outside the pool are spread
+ * round-robin over the workers, jobs submitted from a worker go to its own deque, and a worker
+ * whose deque runs dry steals from the tail of the others before going to sleep. The pool only
+ * ever sees tasks that Core has already admitted, so group rules are enforced before submission.
+ *
+ * The worker threads share the pool state through a QSharedPointer, so destroying the pool never
+ * blocks on a worker that is still busy with a non-cooperative task: the worker finishes its
+ * current job and then exits on its own.
+ */
+class TaskWorkerPool final {
+public:
+    // Workers apply pThreadPolicy, if given, before taking their first job.
+    explicit TaskWorkerPool(int workerCount, QSharedPointer<const TaskThreadPolicy> pThreadPolicy = {});
+    // Adaptive pool: starts minWorkers and adds workers up to maxWorkers while submitted jobs outnumber
+    // idle workers or workers sit in a TaskBlockingRegion. Surplus workers exit after idleTimeoutMs.
+    TaskWorkerPool(int minWorkers, int maxWorkers, int idleTimeoutMs,
+                   QSharedPointer<const TaskThreadPolicy> pThreadPolicy = {});
+    ~TaskWorkerPool();
+
+    TaskWorkerPool(const TaskWorkerPool&) = delete;
+    TaskWorkerPool& operator=(const TaskWorkerPool&) = delete;
+
+    int workerCount() const;
+    int minWorkerCount() const;
+    int maxWorkerCount() const;
+    void submit(std::function<void()> job);
+
+    // For code running on a pool worker: the current size of that pool, or 0 on any other thread.
+    static int currentPoolWorkerCount();
+    // Submits to the pool of the calling worker; false on any other thread.
+    static bool submitToCurrentPool(std::function<void()> job);
+    // Brackets a blocking call on a pool worker; no-ops on any other thread. Nested calls count once.
+    static void beginBlocking();
+    static void endBlocking();
 
-// TaskHelper Implementation
-inline TaskHelper::TaskHelper(std::function<QVariant()> function, std::atomic_bool* pStopFlag, std::atomic_bool* pThreadExited, QObject* parent)
-    : QObject(parent), m_function(function), m_pStopFlag(pStopFlag), m_pThreadExited(pThreadExited) {}
+private:
+    // Padded to a cache line so that workers polling their own deque do not false-share.
+    struct alignas(64) WorkerQueue {
+        std::mutex m_mutex;
+        std::deque<std::function<void()>> m_jobs;
+        bool m_hasWorker = false; // guarded by SharedState::m_growMutex
+    };
 
-inline void TaskHelper::markThreadExited() noexcept {
-    if (m_pThreadExited) {
-        m_pThreadExited->store(true);
-    }
-}
+    struct SharedState {
+        SharedState(int minWorkers, int maxWorkers, int idleTimeoutMs, QSharedPointer<const TaskThreadPolicy> pThreadPolicy);
+
+        bool popLocal(int workerIndex, std::function<void()>& job);
+        bool steal(int thiefIndex, std::function<void()>& job);
+
+        // One queue per worker slot; slots without a live worker are drained by stealing.
+        std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+        std::atomic_int m_pendingJobs{0};
+        std::atomic_int m_sleepingWorkers{0};
+        std::atomic_int m_liveWorkers{0};
+        std::atomic_int m_blockedWorkers{0};
+        std::atomic_uint m_nextQueue{0};
+        std::atomic_bool m_shutdown{false};
+        std::mutex m_sleepMutex;
+        std::condition_variable m_wakeCondition;
+        std::mutex m_growMutex;
+        const int m_minWorkers;
+        const int m_maxWorkers;
+        const int m_targetRunnable; // runnable (not blocked) workers growth aims for
+        const int m_idleTimeoutMs;  // < 0: workers never retire
+        QSharedPointer<const TaskThreadPolicy> m_pThreadPolicy;
+        QWeakPointer<SharedState> m_pSelf;
+    };
 
-inline void TaskHelper::execute() {
-    core_detail::g_currentStopFlag = m_pStopFlag;
-    QVariant result;
-    try {
-        result = m_function();
-    } catch (...) {
-        core_detail::g_currentStopFlag = nullptr;
-        markThreadExited();
-        throw;
-    }
-    core_detail::g_currentStopFlag = nullptr;
-    markThreadExited();
-    emit finished(result);
-}
+    struct WorkerStartInfo {
+        QSharedPointer<SharedState> m_pState;
+        int m_workerIndex;
+    };
 
 #ifdef Q_OS_WIN
-inline DWORD TaskHelper::functionWrapper(void* pTaskHelper) {
-    TaskHelper *pThisTaskHelper = qobject_cast<TaskHelper *>(reinterpret_cast<QObject *>(pTaskHelper));
-    if (pThisTaskHelper) pThisTaskHelper->execute();
-    return 0;
-}
+    static DWORD WINAPI workerEntry(void* pStartInfo);
 #else
-inline void TaskHelper::cleanupThreadExit(void* pTaskHelper) noexcept {
-    TaskHelper *pThisTaskHelper = reinterpret_cast<TaskHelper *>(pTaskHelper);
-    if (pThisTaskHelper) {
-        pThisTaskHelper->markThreadExited();
-    }
-}
-
-inline void* TaskHelper::functionWrapper(void* pTaskHelper) {
-#if defined(PTHREAD_CANCEL_ENABLE) && defined(PTHREAD_CANCEL_ASYNCHRONOUS)
-    // Terminate path uses pthread_cancel; asynchronous cancellation makes forced stop predictable
-    // for non-cooperative tasks (terminateTaskById), while cooperative stop remains unchanged.
-    pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, nullptr);
-    pthread_setcanceltype(PTHREAD_CANCEL_ASYNCHRONOUS, nullptr);
-#endif
-    TaskHelper *pThisTaskHelper = reinterpret_cast<TaskHelper *>(pTaskHelper);
-    if (pThisTaskHelper) {
-        pthread_cleanup_push(&TaskHelper::cleanupThreadExit, pThisTaskHelper);
-        pThisTaskHelper->execute();
-        pthread_cleanup_pop(1);
-    }
-    return nullptr;
-}
+    static void* workerEntry(void* pStartInfo);
 #endif
+    static void runWorker(const QSharedPointer<SharedState>& pState, int workerIndex);
+    static void submitTo(SharedState& state, std::function<void()> job);
+    // Callers hold m_growMutex.
+    static bool startWorker(SharedState& state, int workerIndex);
+    static bool retireWorker(SharedState& state, int workerIndex);
+    static void growIfNeeded(SharedState& state);
+
+    static inline thread_local SharedState* t_pCurrentPool = nullptr;
+    static inline thread_local int t_workerIndex = -1;
+    static inline thread_local int t_blockingDepth = 0;
+
+    QSharedPointer<SharedState> m_pState;
+};
 
-// Core Implementation
-inline Core::Core(QObject* parent)
-    : QObject(parent) {}
+/**
+ * @brief Marks a blocking call (I/O, waiting on a lock, a process or another task) inside a pooled task.
+ *
+ * While the region is open an adaptive worker pool may start a compensating worker, so tasks waiting
+ * on something other than the CPU do not starve the rest of the queue. Outside a pool worker it does nothing.
+ */
+class TaskBlockingRegion final {
+public:
+    TaskBlockingRegion() { TaskWorkerPool::beginBlocking(); }
+    ~TaskBlockingRegion() { TaskWorkerPool::endBlocking(); }
 
-inline Core::~Core() {
-    // Best-effort synchronous shutdown to avoid destroying QObject children while worker threads are still running.
-    if (QThread::currentThread() != thread()) {
-        qWarning() << "Core::~Core - called from non-owner thread. owner =" << thread()
-                   << ", current =" << QThread::currentThread()
-                   << ". Forcing stop flags only.";
-        for (const auto& pTask : std::as_const(m_activeTaskList)) {
-            pTask->m_stopFlag.store(true);
-        }
-        return;
-    }
+    TaskBlockingRegion(const TaskBlockingRegion&) = delete;
+    TaskBlockingRegion& operator=(const TaskBlockingRegion&) = delete;
+};
 
-    // Remove queued tasks first: they never started.
-    for (const auto& pQueuedTask : std::as_const(m_queuedTaskList)) {
-        emit terminatedTask(pQueuedTask->m_id, pQueuedTask->m_type, pQueuedTask->m_argsList);
+namespace core_detail {
+// Shared between a TaskHandle and its task; completed exactly once, with a value or as canceled.
+template <typename R>
+struct TaskHandleState final : TaskHandleStateBase {
+    using Value = std::conditional_t<std::is_void_v<R>, std::monostate, R>;
+
+    TaskHandleState(TaskId id, QObject* pOwner)
+        : m_id(id), m_pOwner(pOwner) {}
+
+    void finish(Value value) { complete(std::move(value)); }
+    void cancel() override { complete(std::nullopt); }
+    void onDone(std::function<void(bool finished)> callback) override {
+        addContinuation([this, callback = std::move(callback)]() { callback(m_value.has_value()); });
     }
-    m_queuedTaskList.clear();
 
-    if (m_activeTaskList.isEmpty()) {
-        return;
+    // Runs the continuation right away if the state is already complete, otherwise on the completing thread.
+    void addContinuation(std::function<void()> continuation) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_done) {
+                m_continuations.push_back(std::move(continuation));
+                return;
+            }
+        }
+        continuation();
     }
 
-    // Block new starts and request cooperative stop for all active tasks.
-    m_blockStartTask.store(true);
-    for (const auto& pTask : std::as_const(m_activeTaskList)) {
-        pTask->m_stopFlag.store(true);
-        if (pTask->m_state == TaskState::Active) {
-            pTask->m_state = TaskState::StopRequested;
-            emit stopRequestedTask(pTask->m_id, pTask->m_type, pTask->m_argsList);
+    const TaskId m_id;
+    const QPointer<QObject> m_pOwner; // the Core; coroutines resume on its thread
+    mutable std::mutex m_mutex;
+    std::condition_variable m_doneCondition;
+    bool m_done = false;
+    std::optional<Value> m_value;
+    std::vector<std::function<void()>> m_continuations;
+
+private:
+    void complete(std::optional<Value> value) {
+        std::vector<std::function<void()>> continuations;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_done) {
+                return;
+            }
+            m_done = true;
+            m_value = std::move(value);
+            continuations.swap(m_continuations);
+        }
+        m_doneCondition.notify_all();
+        for (auto& continuation : continuations) {
+            continuation();
         }
     }
+};
+}
 
-    QElapsedTimer waitTimer;
-    waitTimer.start();
-    constexpr TaskStopTimeout kDtorWaitMs = 2000;
+/**
+ * @brief Typed result of a task added with Core::addTaskWithHandle.
+ *
+ * The result goes straight from the task thread into the handle, without a QVariant round-trip.
+ * A handle is canceled if its task is dropped from the queue, terminated or destroyed before it returns.
+ * Continuations passed to then() without a context run on the thread that completes the task.
+ */
+template <typename R>
+class TaskHandle {
+public:
+    using State = core_detail::TaskHandleState<R>;
+    using Value = typename State::Value;
 
-    while (!m_activeTaskList.isEmpty() && waitTimer.elapsed() < kDtorWaitMs) {
-        QCoreApplication::processEvents(QEventLoop::AllEvents, 20);
-        QThread::msleep(1);
-    }
+    TaskHandle() = default;
+    explicit TaskHandle(QSharedPointer<State> pState)
+        : m_pState(std::move(pState)) {}
 
-    if (m_activeTaskList.isEmpty()) {
-        return;
-    }
+    bool isValid() const { return !m_pState.isNull(); }
+    TaskId id() const { return m_pState ? m_pState->m_id : -1; }
 
-    // Escalate only for stubborn tasks that ignored cooperative stop and only if force termination is allowed.
-    if (m_allowForceTermination) {
-        const auto stubbornTasks = m_activeTaskList;
-        for (const auto& pTask : stubbornTasks) {
-            terminateTask(pTask);
+    bool isDone() const {
+        if (!m_pState) {
+            return false;
         }
-    } else {
-        qWarning() << "Core::~Core - force termination disabled. Active tasks may outlive shutdown window.";
-        return;
+        std::lock_guard<std::mutex> lock(m_pState->m_mutex);
+        return m_pState->m_done;
     }
 
-    while (!m_activeTaskList.isEmpty() && waitTimer.elapsed() < (kDtorWaitMs * 2)) {
-        QCoreApplication::processEvents(QEventLoop::AllEvents, 20);
-        QThread::msleep(1);
+    bool isFinished() const {
+        if (!m_pState) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(m_pState->m_mutex);
+        return m_pState->m_value.has_value();
     }
 
-    if (!m_activeTaskList.isEmpty()) {
-        qWarning() << "Core::~Core - active tasks still present after shutdown timeout:" << m_activeTaskList.size();
+    bool isCanceled() const {
+        if (!m_pState) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(m_pState->m_mutex);
+        return m_pState->m_done && !m_pState->m_value.has_value();
     }
+
+    // Blocks the calling thread; never call it from the Core thread for a task that has not started yet.
+    bool wait(int timeoutMs = -1) const {
+        if (!m_pState) {
+            return false;
+        }
+        // A pooled task waiting on another task lets an adaptive pool compensate for it.
+        TaskBlockingRegion blockingRegion;
+        std::unique_lock<std::mutex> lock(m_pState->m_mutex);
+        if (timeoutMs < 0) {
+            m_pState->m_doneCondition.wait(lock, [this]() { return m_pState->m_done; });
+            return true;
+        }
+        return m_pState->m_doneCondition.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this]() { return m_pState->m_done; });
+    }
+
+    // Waits for the task; throws std::runtime_error if it was canceled.
+    R result() const {
+        if (!m_pState) {
+            throw std::logic_error("TaskHandle::result - invalid handle");
+        }
+        wait();
+        std::lock_guard<std::mutex> lock(m_pState->m_mutex);
+        if (!m_pState->m_value.has_value()) {
+            throw std::runtime_error("TaskHandle::result - task was canceled");
+        }
+        if constexpr (!std::is_void_v<R>) {
+            return *m_pState->m_value;
+        }
+    }
+
+    template <typename F>
+    void then(F&& continuation) const {
+        if (!m_pState) {
+            return;
+        }
+        m_pState->addContinuation([pState = m_pState, continuation = std::forward<F>(continuation)]() mutable {
+            if (pState->m_value.has_value()) {
+                invoke(continuation, *pState->m_value);
+            }
+        });
+    }
+
+    // The continuation is queued to the thread of pContext and dropped if pContext is gone by then.
+    template <typename F>
+    void then(QObject* pContext, F&& continuation) const {
+        if (!m_pState) {
+            return;
+        }
+        m_pState->addContinuation([pState = m_pState, pContext = QPointer<QObject>(pContext), continuation = std::forward<F>(continuation)]() mutable {
+            if (!pState->m_value.has_value() || !pContext) {
+                return;
+            }
+            QMetaObject::invokeMethod(pContext, [continuation = std::move(continuation), value = *pState->m_value]() mutable {
+                invoke(continuation, value);
+            }, Qt::QueuedConnection);
+        });
+    }
+
+    template <typename F>
+    void onCanceled(QObject* pContext, F&& handler) const { // dropped like then() if pContext is gone
+        if (!m_pState) {
+            return;
+        }
+        m_pState->addContinuation([pState = m_pState, pContext = QPointer<QObject>(pContext), handler = std::forward<F>(handler)]() mutable {
+            if (!pState->m_value.has_value() && pContext) {
+                QMetaObject::invokeMethod(pContext, std::move(handler), Qt::QueuedConnection);
+            }
+        });
+    }
+
+#ifdef CORE_HAS_COROUTINES
+    // co_await resumes the coroutine on the Core thread once the task is done.
+    struct Awaiter {
+        QSharedPointer<State> m_pState;
+
+        bool await_ready() const { return TaskHandle(m_pState).isDone(); }
+        void await_suspend(std::coroutine_handle<> coroutine) {
+            // A coroutine awaiting a handle of a deleted Core is never resumed.
+            m_pState->addContinuation([pOwner = m_pState->m_pOwner, coroutine]() {
+                if (!pOwner) {
+                    return;
+                }
+                QMetaObject::invokeMethod(pOwner, [coroutine]() { coroutine.resume(); }, Qt::QueuedConnection);
+            });
+        }
+        R await_resume() const { return TaskHandle(m_pState).result(); }
+    };
+
+    Awaiter operator co_await() const {
+        if (!m_pState) {
+            throw std::logic_error("TaskHandle - co_await on an invalid handle");
+        }
+        return Awaiter{m_pState};
+    }
+#endif
+
+private:
+    template <typename F>
+    static void invoke(F& function, const Value& value) {
+        if constexpr (std::is_void_v<R>) {
+            Q_UNUSED(value);
+            function();
+        } else {
+            function(value);
+        }
+    }
+
+    friend class TaskDependency;
+    QSharedPointer<State> m_pState;
+};
+
+/**
+ * @brief A TaskHandle of any result type, used to declare what Core::addTaskAfter waits for.
+ */
+class TaskDependency {
+public:
+    template <typename R>
+    TaskDependency(const TaskHandle<R>& handle)
+        : m_id(handle.id()), m_pState(handle.m_pState) {}
+
+    TaskId id() const { return m_id; }
+
+private:
+    friend class Core;
+    TaskId m_id;
+    QSharedPointer<core_detail::TaskHandleStateBase> m_pState;
+};
+
+/**
+ * @brief Cooperative cancellation shared by a family of tasks (see Core::addTaskWithToken).
+ *
+ * Copies share one state. cancel() cancels this token and every token created from it with createChild(),
+ * however deep, and sets the stop flag of each running task added with one of them. Tasks notice it the
+ * next time they poll the flag returned by Core::stopTaskFlag().
+ */
+class TaskCancellationToken {
+public:
+    TaskCancellationToken()
+        : m_pNode(QSharedPointer<core_detail::CancellationNode>::create()) {}
+
+    TaskCancellationToken createChild() const {
+        auto pChild = QSharedPointer<core_detail::CancellationNode>::create(m_pNode);
+        m_pNode->addChild(pChild);
+        return TaskCancellationToken(std::move(pChild));
+    }
+    void cancel() const { m_pNode->cancel(); }
+    bool isCanceled() const { return m_pNode->isCanceled(); }
+
+private:
+    explicit TaskCancellationToken(QSharedPointer<core_detail::CancellationNode> pNode)
+        : m_pNode(std::move(pNode)) {}
+
+    friend class Core;
+    QSharedPointer<core_detail::CancellationNode> m_pNode;
+};
+
+namespace core_detail {
+// One data-parallel run: the task thread and pool helpers claim chunks from a shared cursor and
+// fold their partial results; helpers that start after the task thread is done simply return.
+template <typename R>
+struct ChunkedRun {
+    qint64 m_end = 0;
+    qint64 m_grainSize = 1;
+    std::atomic<qint64> m_next{0};
+    std::function<R(qint64, qint64)> m_map;
+    std::function<R(R, R)> m_reduce;
+    std::atomic_bool* m_pStopFlag = nullptr; // the parent task's flag, shared by every chunk
+
+    std::mutex m_mutex;
+    std::condition_variable m_helpersDone;
+    int m_runningHelpers = 0;
+    bool m_closed = false;
+    std::optional<R> m_result;
+
+    void work() {
+        std::atomic_bool* pPreviousStopFlag = g_currentStopFlag;
+        g_currentStopFlag = m_pStopFlag;
+        std::optional<R> partial;
+        while (m_pStopFlag == nullptr || !m_pStopFlag->load()) {
+            const qint64 begin = m_next.fetch_add(m_grainSize);
+            if (begin >= m_end) {
+                break;
+            }
+            R chunkResult = m_map(begin, std::min(begin + m_grainSize, m_end));
+            partial = partial ? m_reduce(std::move(*partial), std::move(chunkResult)) : std::move(chunkResult);
+        }
+        g_currentStopFlag = pPreviousStopFlag;
+
+        if (partial) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_result = m_result ? m_reduce(std::move(*m_result), std::move(*partial)) : std::move(*partial);
+        }
+    }
+};
+
+template <typename R>
+R runChunked(qint64 begin, qint64 end, qint64 grainSize, std::function<R(qint64, qint64)> map, std::function<R(R, R)> reduce, R identity) {
+    if (begin >= end) {
+        return identity;
+    }
+
+    const int workerCount = TaskWorkerPool::currentPoolWorkerCount();
+    auto pRun = QSharedPointer<ChunkedRun<R>>::create();
+    pRun->m_end = end;
+    pRun->m_grainSize = grainSize > 0 ? grainSize : std::max<qint64>(1, (end - begin) / (std::max(1, workerCount) * 4));
+    pRun->m_next.store(begin);
+    pRun->m_map = std::move(map);
+    pRun->m_reduce = std::move(reduce);
+    pRun->m_pStopFlag = g_currentStopFlag;
+
+    // The task thread is one participant; outside a pool it processes every chunk itself.
+    const qint64 chunkCount = (end - begin + pRun->m_grainSize - 1) / pRun->m_grainSize;
+    const qint64 helperCount = std::min<qint64>(chunkCount, workerCount) - 1;
+    for (qint64 i = 0; i < helperCount; ++i) {
+        TaskWorkerPool::submitToCurrentPool([pRun]() {
+            {
+                std::lock_guard<std::mutex> lock(pRun->m_mutex);
+                if (pRun->m_closed) {
+                    return;
+                }
+                ++pRun->m_runningHelpers;
+            }
+            pRun->work();
+            std::lock_guard<std::mutex> lock(pRun->m_mutex);
+            if (--pRun->m_runningHelpers == 0) {
+                pRun->m_helpersDone.notify_all();
+            }
+        });
+    }
+
+    pRun->work();
+
+    // Only helpers already inside a chunk are waited for, so a busy pool cannot stall the task.
+    std::unique_lock<std::mutex> lock(pRun->m_mutex);
+    pRun->m_closed = true;
+    pRun->m_helpersDone.wait(lock, [&pRun]() { return pRun->m_runningHelpers == 0; });
+    return pRun->m_result ? std::move(*pRun->m_result) : std::move(identity);
+}
+
+// Bounded MPMC ring (Vyukov): each cell's sequence number tells producers and consumers whose turn it is.
+template <typename T>
+class BoundedRing {
+public:
+    explicit BoundedRing(int capacity) {
+        std::size_t size = 2;
+        while (size < static_cast<std::size_t>(capacity)) {
+            size <<= 1;
+        }
+        m_mask = size - 1;
+        m_cells.reset(new Cell[size]);
+        for (std::size_t i = 0; i < size; ++i) {
+            m_cells[i].m_sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    int capacity() const { return static_cast<int>(m_mask + 1); }
+
+    // Leaves value untouched when the ring is full.
+    template <typename U>
+    bool tryPush(U&& value) {
+        std::size_t pos = m_pushPos.load(std::memory_order_relaxed);
+        Cell* pCell = nullptr;
+        for (;;) {
+            pCell = &m_cells[pos & m_mask];
+            const std::size_t sequence = pCell->m_sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (m_pushPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_pushPos.load(std::memory_order_relaxed);
+            }
+        }
+        pCell->m_value.emplace(std::forward<U>(value));
+        pCell->m_sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(std::optional<T>& value) {
+        std::size_t pos = m_popPos.load(std::memory_order_relaxed);
+        Cell* pCell = nullptr;
+        for (;;) {
+            pCell = &m_cells[pos & m_mask];
+            const std::size_t sequence = pCell->m_sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (m_popPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_popPos.load(std::memory_order_relaxed);
+            }
+        }
+        value.emplace(std::move(*pCell->m_value));
+        pCell->m_value.reset();
+        pCell->m_sequence.store(pos + m_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> m_sequence{0};
+        std::optional<T> m_value;
+    };
+
+    std::unique_ptr<Cell[]> m_cells;
+    std::size_t m_mask = 0;
+    alignas(64) std::atomic<std::size_t> m_pushPos{0};
+    alignas(64) std::atomic<std::size_t> m_popPos{0};
+};
+
+template <typename T>
+struct ChannelState {
+    explicit ChannelState(int capacity)
+        : m_ring(capacity) {}
+
+    BoundedRing<T> m_ring;
+    std::atomic_bool m_closed{false};
+    std::atomic_int m_writers{0}; // pipeline stages that still write; the last one closes the channel
+};
+
+// Held by a pipeline stage task; releasing the last writer of a channel closes it.
+class ChannelWriter {
+public:
+    explicit ChannelWriter(std::function<void()> release)
+        : m_release(std::move(release)) {}
+    ~ChannelWriter() { release(); }
+
+    void release() {
+        if (!m_released.exchange(true)) {
+            m_release();
+        }
+    }
+
+private:
+    std::function<void()> m_release;
+    std::atomic_bool m_released{false};
+};
+using ChannelWriterPtr = QSharedPointer<ChannelWriter>;
+
+// Thread creation with an optional stack size; a size the platform rejects falls back to the default.
+#ifdef Q_OS_WIN
+inline HANDLE createThread(std::size_t stackSize, LPTHREAD_START_ROUTINE entry, void* pArgument, DWORD* pThreadId) {
+    return CreateThread(nullptr, static_cast<SIZE_T>(stackSize), entry, pArgument,
+                        stackSize ? STACK_SIZE_PARAM_IS_A_RESERVATION : 0, pThreadId);
+}
+#else
+inline int createThread(pthread_t* pThread, std::size_t stackSize, void* (*entry)(void*), void* pArgument) {
+    if (stackSize == 0) {
+        return pthread_create(pThread, nullptr, entry, pArgument);
+    }
+    pthread_attr_t attributes;
+    pthread_attr_init(&attributes);
+    if (const int error = pthread_attr_setstacksize(&attributes, stackSize); error != 0) {
+        qWarning() << "TaskThreadPolicy - Stack size rejected:" << stackSize << ". Error code:" << error;
+    }
+    const int result = pthread_create(pThread, &attributes, entry, pArgument);
+    pthread_attr_destroy(&attributes);
+    return result;
+}
+#endif
+
+// The CPUs of a NUMA node, read on the owner thread when a policy is set; empty if unknown.
+inline QVector<int> numaNodeCpus(int node) {
+    QVector<int> cpus;
+#if defined(Q_OS_LINUX)
+    // cpulist looks like "0-3,8-11".
+    QFile file(QStringLiteral("/sys/devices/system/node/node%1/cpulist").arg(node));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return cpus;
+    }
+    const auto ranges = file.readAll().trimmed().split(',');
+    for (const QByteArray& range : ranges) {
+        const int dash = range.indexOf('-');
+        const int first = range.left(dash < 0 ? range.size() : dash).toInt();
+        const int last = dash < 0 ? first : range.mid(dash + 1).toInt();
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.append(cpu);
+        }
+    }
+#elif defined(Q_OS_WIN)
+    ULONGLONG mask = 0;
+    if (node <= 0xFF && GetNumaNodeProcessorMask(static_cast<UCHAR>(node), &mask)) {
+        for (int cpu = 0; cpu < 64; ++cpu) {
+            if (mask & (ULONGLONG(1) << cpu)) {
+                cpus.append(cpu);
+            }
+        }
+    }
+#else
+    Q_UNUSED(node);
+#endif
+    return cpus;
+}
+
+// The TaskThreadPolicy name of this thread, NUL-terminated, for TaskTracer.
+inline constexpr int kThreadNameCapacity = 32;
+inline thread_local char t_threadName[kThreadNameCapacity] = {};
+
+// Runs on the thread itself, first thing after it starts.
+inline void applyCurrentThreadPolicy(const TaskThreadPolicy& policy) {
+#ifdef Q_OS_WIN
+    const HANDLE thread = GetCurrentThread();
+    if (!policy.cpuAffinity.isEmpty()) {
+        DWORD_PTR mask = 0;
+        for (int cpu : policy.cpuAffinity) {
+            if (cpu >= 0 && cpu < static_cast<int>(sizeof(DWORD_PTR) * 8)) {
+                mask |= DWORD_PTR(1) << cpu;
+            }
+        }
+        if (mask == 0 || SetThreadAffinityMask(thread, mask) == 0) {
+            qWarning() << "TaskThreadPolicy - Failed to set CPU affinity. GetLastError:" << GetLastError();
+        }
+    }
+    if (policy.priority != QThread::InheritPriority) {
+        static const int kWindowsPriorities[] = {
+            THREAD_PRIORITY_IDLE, THREAD_PRIORITY_LOWEST, THREAD_PRIORITY_BELOW_NORMAL, THREAD_PRIORITY_NORMAL,
+            THREAD_PRIORITY_ABOVE_NORMAL, THREAD_PRIORITY_HIGHEST, THREAD_PRIORITY_TIME_CRITICAL
+        };
+        if (!SetThreadPriority(thread, kWindowsPriorities[policy.priority])) {
+            qWarning() << "TaskThreadPolicy - Failed to set thread priority. GetLastError:" << GetLastError();
+        }
+    }
+    if (!policy.threadName.isEmpty()) {
+        // SetThreadDescription exists from Windows 10 1607 on, so it is looked up at run time.
+        using SetThreadDescriptionFunction = HRESULT(WINAPI*)(HANDLE, PCWSTR);
+        static const auto pSetThreadDescription = reinterpret_cast<SetThreadDescriptionFunction>(
+            reinterpret_cast<void*>(GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "SetThreadDescription")));
+        if (pSetThreadDescription) {
+            pSetThreadDescription(thread, reinterpret_cast<PCWSTR>(policy.threadName.utf16()));
+        }
+    }
+#else
+    #if defined(Q_OS_LINUX)
+    if (!policy.cpuAffinity.isEmpty()) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (int cpu : policy.cpuAffinity) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &cpus);
+            }
+        }
+        if (const int error = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus); error != 0) {
+            qWarning() << "TaskThreadPolicy - Failed to set CPU affinity. Error code:" << error;
+        }
+    }
+    #endif
+    if (policy.priority != QThread::InheritPriority) {
+        // Spread over the range of the current scheduling policy, as QThread::setPriority does.
+        int schedulingPolicy = SCHED_OTHER;
+        sched_param parameters{};
+        pthread_getschedparam(pthread_self(), &schedulingPolicy, &parameters);
+    #ifdef SCHED_IDLE
+        if (policy.priority == QThread::IdlePriority) {
+            schedulingPolicy = SCHED_IDLE;
+            parameters.sched_priority = 0;
+        } else
+    #endif
+        {
+            const int lowest = sched_get_priority_min(schedulingPolicy);
+            const int highest = sched_get_priority_max(schedulingPolicy);
+            parameters.sched_priority = lowest + (highest - lowest) * (policy.priority - QThread::IdlePriority)
+                                                     / (QThread::TimeCriticalPriority - QThread::IdlePriority);
+        }
+        if (const int error = pthread_setschedparam(pthread_self(), schedulingPolicy, &parameters); error != 0) {
+            qWarning() << "TaskThreadPolicy - Failed to set thread priority. Error code:" << error;
+        }
+    }
+    if (!policy.threadName.isEmpty()) {
+    #if defined(Q_OS_LINUX)
+        pthread_setname_np(pthread_self(), policy.threadName.toUtf8().left(15).constData());
+    #elif defined(Q_OS_DARWIN)
+        pthread_setname_np(policy.threadName.toUtf8().constData());
+    #endif
+    }
+#endif
+    if (!policy.threadName.isEmpty()) {
+        QThread::currentThread()->setObjectName(policy.threadName);
+        // Copied by the tracer without allocating; the last byte stays the terminator.
+        const QByteArray name = policy.threadName.toUtf8().left(kThreadNameCapacity - 1);
+        std::fill(std::begin(t_threadName), std::end(t_threadName), '\0');
+        std::copy(name.constData(), name.constData() + name.size(), t_threadName);
+    }
+}
+
+// Microseconds on a monotonic clock; only read while metrics are enabled.
+inline qint64 steadyMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+enum class TraceEventKind : int {
+    Queued,
+    Started,
+    RunBegin, // recorded on the task thread
+    RunEnd,   // recorded on the task thread
+    StopRequested,
+    StopTimedOut,
+    Finished,
+    Terminated,
+    Dropped,
+    Expired
+};
+
+// Lifecycle event recorder: all threads share one ring of fixed-size slots, so recording takes no lock
+// and allocates nothing, even on a task thread that may be canceled asynchronously. A writer claims a
+// slot with one fetch_add and publishes it seqlock-style; dumping may run concurrently and skips slots
+// that are being written or were lapped meanwhile.
+class TaskTracer final {
+public:
+    explicit TaskTracer(int eventCapacity)
+        : m_capacity(static_cast<quint64>(std::max(16, eventCapacity)))
+        , m_generation(s_nextGeneration.fetch_add(1))
+        , m_events(new Event[m_capacity])
+        , m_threadNames(new ThreadName[kMaxNamedThreads]) {}
+
+    void record(TraceEventKind kind, TaskId taskId, TaskType taskType, TaskGroup taskGroup) {
+        const int tid = currentTid();
+        const quint64 index = m_next.fetch_add(1, std::memory_order_relaxed);
+        Event& event = m_events[index % m_capacity];
+        event.m_sequence.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        event.m_timestampUs.store(steadyMicros(), std::memory_order_relaxed);
+        event.m_taskId.store(taskId, std::memory_order_relaxed);
+        event.m_type.store(taskType, std::memory_order_relaxed);
+        event.m_group.store(taskGroup, std::memory_order_relaxed);
+        event.m_kind.store(static_cast<int>(kind), std::memory_order_relaxed);
+        event.m_tid.store(tid, std::memory_order_relaxed);
+        event.m_sequence.store(2 * index + 2, std::memory_order_release);
+    }
+
+    QByteArray toChromeTraceJson() const;
+
+private:
+    static constexpr int kMaxNamedThreads = 1024; // later threads are still traced, as "thread N"
+
+    struct Event {
+        std::atomic<quint64> m_sequence{0}; // 2 * index + 2 once the event at index is complete, odd while written
+        std::atomic<qint64> m_timestampUs{0};
+        std::atomic<qint64> m_taskId{0};
+        std::atomic<qint64> m_type{0};
+        std::atomic<qint64> m_group{0};
+        std::atomic<int> m_kind{0};
+        std::atomic<int> m_tid{0};
+    };
+
+    // Filled once by the thread itself from t_threadName, the name its TaskThreadPolicy gave it.
+    struct ThreadName {
+        std::atomic_bool m_ready{false};
+        char m_name[kThreadNameCapacity] = {};
+    };
+
+    struct Snapshot {
+        qint64 m_timestampUs;
+        TaskId m_taskId;
+        TaskType m_type;
+        TaskGroup m_group;
+        TraceEventKind m_kind;
+        int m_tid;
+    };
+
+    int currentTid() {
+        if (t_generation == m_generation) {
+            return t_tid;
+        }
+        const int tid = m_nextTid.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (tid <= kMaxNamedThreads) {
+            ThreadName& threadName = m_threadNames[tid - 1];
+            std::copy(std::begin(t_threadName), std::end(t_threadName), threadName.m_name);
+            threadName.m_ready.store(true, std::memory_order_release);
+        }
+        t_generation = m_generation;
+        t_tid = tid;
+        return tid;
+    }
+
+    const quint64 m_capacity;
+    const quint64 m_generation; // tells the thread_local cache which tracer it belongs to
+    const std::unique_ptr<Event[]> m_events;
+    const std::unique_ptr<ThreadName[]> m_threadNames;
+    std::atomic<quint64> m_next{0};
+    std::atomic_int m_nextTid{0};
+
+    static inline std::atomic<quint64> s_nextGeneration{1};
+    static inline thread_local quint64 t_generation = 0;
+    static inline thread_local int t_tid = 0;
+};
+
+inline QByteArray TaskTracer::toChromeTraceJson() const {
+    static const char* const kEventNames[] = {
+        "queued", "started", "run", "run", "stop requested", "stop timed out", "finished", "terminated", "dropped", "expired"
+    };
+
+    std::vector<Snapshot> events;
+    const quint64 written = m_next.load(std::memory_order_acquire);
+    const quint64 first = written > m_capacity ? written - m_capacity : 0;
+    events.reserve(static_cast<std::size_t>(written - first));
+    for (quint64 index = first; index < written; ++index) {
+        const Event& event = m_events[index % m_capacity];
+        const quint64 sequence = event.m_sequence.load(std::memory_order_acquire);
+        Snapshot snapshot{event.m_timestampUs.load(std::memory_order_relaxed), event.m_taskId.load(std::memory_order_relaxed),
+                          static_cast<TaskType>(event.m_type.load(std::memory_order_relaxed)),
+                          static_cast<TaskGroup>(event.m_group.load(std::memory_order_relaxed)),
+                          static_cast<TraceEventKind>(event.m_kind.load(std::memory_order_relaxed)), event.m_tid.load(std::memory_order_relaxed)};
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // Still being written, or lapped by a newer event while we copied it.
+        if (sequence != 2 * index + 2 || event.m_sequence.load(std::memory_order_relaxed) != sequence) {
+            continue;
+        }
+        events.push_back(snapshot);
+    }
+
+    QVector<QPair<int, QString>> threadNames;
+    const int tidCount = m_nextTid.load(std::memory_order_acquire);
+    for (int tid = 1; tid <= tidCount; ++tid) {
+        QString name;
+        if (tid <= kMaxNamedThreads && m_threadNames[tid - 1].m_ready.load(std::memory_order_acquire)) {
+            name = QString::fromUtf8(m_threadNames[tid - 1].m_name);
+        }
+        threadNames.append({tid, name.isEmpty() ? QStringLiteral("thread %1").arg(tid) : name});
+    }
+    std::stable_sort(events.begin(), events.end(), [](const Snapshot& left, const Snapshot& right) {
+        return left.m_timestampUs < right.m_timestampUs;
+    });
+
+    QByteArray json("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    bool firstEvent = true;
+    auto append = [&json, &firstEvent](const QByteArray& event) {
+        if (!firstEvent) {
+            json.append(',');
+        }
+        firstEvent = false;
+        json.append(event);
+    };
+    for (const auto& threadName : std::as_const(threadNames)) {
+        QString name = threadName.second;
+        name.replace(QLatin1Char('\\'), QLatin1String("\\\\")).replace(QLatin1Char('"'), QLatin1String("\\\""));
+        append(QByteArray("{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":") + QByteArray::number(threadName.first)
+               + ",\"args\":{\"name\":\"" + name.toUtf8() + "\"}}");
+    }
+
+    // Runs become complete slices on the thread that ran them; queue waits become async spans per group.
+    QHash<TaskId, const Snapshot*> runBegins;
+    for (const auto& event : events) {
+        const QByteArray common = ",\"pid\":1,\"tid\":" + QByteArray::number(event.m_tid) + ",\"ts\":" + QByteArray::number(event.m_timestampUs)
+                                  + ",\"args\":{\"id\":" + QByteArray::number(event.m_taskId) + ",\"type\":" + QByteArray::number(event.m_type)
+                                  + ",\"group\":" + QByteArray::number(event.m_group) + "}";
+        const QByteArray taskName = "\"type " + QByteArray::number(event.m_type) + "\"";
+        switch (event.m_kind) {
+        case TraceEventKind::RunBegin:
+            runBegins.insert(event.m_taskId, &event);
+            break;
+        case TraceEventKind::RunEnd:
+            if (const Snapshot* pBegin = runBegins.take(event.m_taskId); pBegin && pBegin->m_tid == event.m_tid) {
+                append("{\"ph\":\"X\",\"cat\":\"run\",\"name\":" + taskName + ",\"pid\":1,\"tid\":" + QByteArray::number(event.m_tid)
+                       + ",\"ts\":" + QByteArray::number(pBegin->m_timestampUs) + ",\"dur\":" + QByteArray::number(event.m_timestampUs - pBegin->m_timestampUs)
+                       + ",\"args\":{\"id\":" + QByteArray::number(event.m_taskId) + ",\"group\":" + QByteArray::number(event.m_group) + "}}");
+            }
+            break;
+        case TraceEventKind::Queued:
+        case TraceEventKind::Started:
+        case TraceEventKind::Dropped:
+        case TraceEventKind::Expired:
+            if (event.m_kind != TraceEventKind::Queued) {
+                append("{\"ph\":\"i\",\"s\":\"t\",\"cat\":\"state\",\"name\":\"" + QByteArray(kEventNames[static_cast<int>(event.m_kind)]) + "\"" + common + "}");
+            }
+            // Closing an async span that was never opened is ignored by the viewers.
+            append(QByteArray("{\"ph\":\"") + (event.m_kind == TraceEventKind::Queued ? "b" : "e") + "\",\"cat\":\"queue\",\"name\":\"group "
+                   + QByteArray::number(event.m_group) + " queue\",\"id\":" + QByteArray::number(event.m_taskId) + common + "}");
+            break;
+        default:
+            append("{\"ph\":\"i\",\"s\":\"t\",\"cat\":\"state\",\"name\":\"" + QByteArray(kEventNames[static_cast<int>(event.m_kind)]) + "\"" + common + "}");
+            break;
+        }
+    }
+    // Tasks still running when the trace was taken.
+    for (const Snapshot* pBegin : std::as_const(runBegins)) {
+        append("{\"ph\":\"B\",\"cat\":\"run\",\"name\":\"type " + QByteArray::number(pBegin->m_type) + "\",\"pid\":1,\"tid\":"
+               + QByteArray::number(pBegin->m_tid) + ",\"ts\":" + QByteArray::number(pBegin->m_timestampUs) + "}");
+    }
+    json.append("]}");
+    return json;
+}
+
+inline bool isCurrentTaskStopRequested() {
+    return g_currentStopFlag != nullptr && g_currentStopFlag->load();
+}
+
+// Spins briefly, then yields, then sleeps, so waiting stages do not burn a core.
+inline void channelBackoff(int attempt) {
+    if (attempt < 16) {
+        return;
+    }
+    if (attempt < 64) {
+        QThread::yieldCurrentThread();
+        return;
+    }
+    QThread::usleep(attempt < 256 ? 50 : 500);
+}
+}
+
+/**
+ * @brief Bounded lock-free channel connecting pipeline stages (multi-producer, multi-consumer).
+ *
+ * Copies share one buffer. Blocking push/pop return false/empty once the channel is closed or the calling
+ * task was asked to stop, so stage loops end with their task.
+ */
+template <typename T>
+class TaskChannel {
+public:
+    explicit TaskChannel(int capacity = kDefaultChannelCapacity)
+        : m_pState(QSharedPointer<core_detail::ChannelState<T>>::create(capacity)) {}
+
+    int capacity() const { return m_pState->m_ring.capacity(); }
+    bool isClosed() const { return m_pState->m_closed.load(std::memory_order_acquire); }
+    // Readers drain what is left; later pushes fail.
+    void close() { m_pState->m_closed.store(true, std::memory_order_release); }
+
+    template <typename U>
+    bool tryPush(U&& value) {
+        return !isClosed() && m_pState->m_ring.tryPush(std::forward<U>(value));
+    }
+
+    // Waits while the channel is full; this is the backpressure between stages.
+    template <typename U>
+    bool push(U&& value) {
+        for (int attempt = 0;; ++attempt) {
+            if (isClosed() || core_detail::isCurrentTaskStopRequested()) {
+                return false;
+            }
+            if (m_pState->m_ring.tryPush(std::forward<U>(value))) {
+                return true;
+            }
+            core_detail::channelBackoff(attempt);
+        }
+    }
+
+    std::optional<T> tryPop() {
+        std::optional<T> value;
+        m_pState->m_ring.tryPop(value);
+        return value;
+    }
+
+    // Waits for an item; empty once the channel is closed and drained or the task is stopping.
+    std::optional<T> pop() {
+        std::optional<T> value;
+        for (int attempt = 0;; ++attempt) {
+            if (m_pState->m_ring.tryPop(value)) {
+                return value;
+            }
+            if (isClosed()) {
+                // An item may have been pushed right before close().
+                m_pState->m_ring.tryPop(value);
+                return value;
+            }
+            if (core_detail::isCurrentTaskStopRequested()) {
+                return value;
+            }
+            core_detail::channelBackoff(attempt);
+        }
+    }
+
+private:
+    friend class Core;
+
+    core_detail::ChannelWriterPtr acquireWriter() const {
+        m_pState->m_writers.fetch_add(1);
+        return core_detail::ChannelWriterPtr::create([pState = m_pState]() {
+            if (pState->m_writers.fetch_sub(1) == 1) {
+                pState->m_closed.store(true, std::memory_order_release);
+            }
+        });
+    }
+
+    QSharedPointer<core_detail::ChannelState<T>> m_pState;
+};
+
+#ifdef CORE_HAS_COROUTINES
+/**
+ * @brief Minimal fire-and-forget coroutine type for code that co_awaits TaskHandles.
+ *
+ * Starts eagerly and destroys itself when it returns; exceptions are logged and swallowed.
+ */
+struct TaskCoroutine {
+    struct promise_type {
+        TaskCoroutine get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept {
+            try {
+                throw;
+            } catch (const std::exception& e) {
+                qWarning() << "TaskCoroutine - unhandled exception:" << e.what();
+            } catch (...) {
+                qWarning() << "TaskCoroutine - unhandled exception";
+            }
+        }
+    };
+};
+#endif
+
+namespace core_detail {
+struct StaticTaskBase {};
+
+template <typename F>
+struct StaticTaskSignature {
+    static constexpr bool isFunctionPointer = false;
+};
+
+// Binds a static task's arguments the way registerTask does: stored decayed, forwarded as declared.
+template <typename R, typename... Params>
+struct StaticTaskSignature<R (*)(Params...)> {
+    static constexpr bool isFunctionPointer = true;
+    static constexpr bool hasVariantResult = std::is_void_v<R> || std::is_convertible_v<R, QVariant> || QMetaTypeId<R>::Defined;
+    using BoundArgs = std::tuple<std::decay_t<Params>...>;
+
+    template <auto Function>
+    static QVariant call(BoundArgs& boundArgs) {
+        return std::apply([](auto&... args) -> QVariant {
+            if constexpr (std::is_void_v<R>) {
+                Function(std::forward<Params>(args)...);
+                return QVariant();
+            } else if constexpr (std::is_convertible_v<R, QVariant>) {
+                return Function(std::forward<Params>(args)...);
+            } else {
+                return QVariant::fromValue(Function(std::forward<Params>(args)...));
+            }
+        }, boundArgs);
+    }
+};
+
+template <typename Definition>
+using StaticTaskSignatureOf = StaticTaskSignature<std::remove_cv_t<decltype(Definition::function)>>;
+
+template <typename Definition>
+inline constexpr bool isStaticTask = std::is_base_of_v<StaticTaskBase, Definition>;
+
+template <typename... Definitions>
+constexpr bool hasUniqueStaticTaskTypes() {
+    const std::array<TaskType, sizeof...(Definitions)> types{Definitions::type...};
+    for (std::size_t i = 0; i < types.size(); ++i) {
+        for (std::size_t j = i + 1; j < types.size(); ++j) {
+            if (types[i] == types[j]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+} // namespace core_detail
+
+/**
+ * @brief A task type fixed at build time: its id, function, group and stop timeout are template arguments.
+ *
+ * Register a list of them with Core::registerStaticTasks<...>() and add tasks with Core::addTask<Definition>(args...):
+ * the call is bound directly to Function, and arguments that do not fit its parameters fail to compile.
+ *
+ *     using ResizeTask = StaticTask<1, &resizeImage>;
+ *     core.registerStaticTasks<ResizeTask, StaticTask<2, &blurImage, 1>>();
+ *     core.addTask<ResizeTask>(image, 640);
+ */
+template <TaskType Type, auto Function, TaskGroup Group = 0, TaskStopTimeout StopTimeout = kDefaultStopTimeout>
+struct StaticTask : core_detail::StaticTaskBase {
+    static_assert(core_detail::StaticTaskSignature<decltype(Function)>::isFunctionPointer,
+                  "StaticTask - Function must be a pointer to a free or static member function");
+    static_assert(StopTimeout >= 0, "StaticTask - negative stop timeout");
+
+    static constexpr TaskType type = Type;
+    static constexpr auto function = Function;
+    static constexpr TaskGroup group = Group;
+    static constexpr TaskStopTimeout stopTimeout = StopTimeout;
+    // Its address identifies this definition in the runtime registry.
+    static constexpr char registrationTag = 0;
+};
+
+/**
+ * @brief The Core class manages task execution in separate threads.
+ *
+ * IMPORTANT: All public methods of this class (e.g., addTask, stopTaskById, etc.)
+ * must be called from the same thread where the Core object lives (typically the main GUI thread).
+ * Calling these methods from task threads concurrently may lead to undefined behavior.
+ */
+class Core : public QObject {
+    Q_OBJECT
+
+public:
+    enum class ExecutionMode {
+        DedicatedThreads, // one OS thread per started task (default)
+        WorkerPool        // tasks run on a fixed set of reused worker threads
+    };
+
+    // How addTask fills the argsList carried by the task signals.
+    enum class ArgsCapture {
+        Eager,    // always convert the arguments to QVariant (default)
+        Lazy,     // convert only if a receiver is connected to a signal that carries argsList
+        Disabled  // never convert; signals carry an empty argsList
+    };
+
+    // How a finished task is reported.
+    enum class ResultDelivery {
+        PerTask,  // one finishedTask signal per task (default)
+        Batched   // collected and reported together through finishedTasks
+    };
+
+    struct TaskResult {
+        TaskId id = 0;
+        TaskType type = 0;
+        QList<QVariant> argsList;
+        QVariant result;
+    };
+
+    // Ids handed out by addTasks: first, first + 1, ..., first + count - 1.
+    struct TaskIdRange {
+        TaskId first = 0;
+        TaskId count = 0;
+
+        bool isEmpty() const { return count == 0; }
+        bool contains(TaskId id) const { return id >= first && id < first + count; }
+    };
+
+    // Power-of-two buckets: bucket i counts samples below 2^i microseconds, the last one everything above.
+    struct LatencyHistogram {
+        static constexpr int kBucketCount = 24;
+
+        std::array<quint64, kBucketCount> buckets{};
+        quint64 count = 0;
+        quint64 totalUs = 0;
+        quint64 maxUs = 0;
+
+        void record(qint64 us) {
+            const quint64 value = us > 0 ? static_cast<quint64>(us) : 0;
+            int bucket = 0;
+            while (bucket < kBucketCount - 1 && value >= (quint64(1) << bucket)) {
+                ++bucket;
+            }
+            ++buckets[bucket];
+            ++count;
+            totalUs += value;
+            maxUs = std::max(maxUs, value);
+        }
+        double meanUs() const { return count ? static_cast<double>(totalUs) / count : 0.0; }
+        // Upper bound of the bucket holding the given fraction (0..1) of the samples.
+        quint64 percentileUs(double fraction) const {
+            const quint64 rank = static_cast<quint64>(fraction * count);
+            quint64 seen = 0;
+            for (int i = 0; i < kBucketCount - 1; ++i) {
+                seen += buckets[i];
+                if (seen > rank) {
+                    return std::min(quint64(1) << i, maxUs);
+                }
+            }
+            return maxUs;
+        }
+    };
+
+    struct TaskMetrics {
+        quint64 added = 0;
+        quint64 started = 0;
+        quint64 finished = 0;
+        quint64 terminated = 0;      // killed after a stop timeout
+        quint64 dropped = 0;         // removed from a queue before starting
+        quint64 expired = 0;         // deadline passed before it started
+        quint64 stopRequests = 0;
+        quint64 stopTimeouts = 0;
+        quint64 startFailures = 0;   // thread creation failed
+        int queued = 0;              // depth when the snapshot was taken
+        int active = 0;
+        LatencyHistogram queueWait;  // added or released until started
+        LatencyHistogram runTime;    // measured on the task thread
+        LatencyHistogram stopLatency; // stop request until the task returned or was terminated
+    };
+
+    struct MetricsSnapshot {
+        TaskMetrics total;
+        QHash<TaskType, TaskMetrics> byType;
+        QHash<TaskGroup, TaskMetrics> byGroup;
+    };
+
+    explicit Core(QObject* parent = nullptr);
+    ~Core() override;
+
+    template <typename R, typename... Args>
+    void registerTask(TaskType taskType, std::function<R(Args...)> taskFunction, TaskGroup taskGroup = 0, TaskStopTimeout taskStopTimeout = kDefaultStopTimeout);
+
+    template <typename R, typename... Args>
+    void registerTask(TaskType taskType, R (*taskFunction)(Args...), TaskGroup taskGroup = 0, TaskStopTimeout taskStopTimeout = kDefaultStopTimeout);
+
+    template <typename Class, typename R, typename... Args>
+    void registerTask(TaskType taskType, R (Class::*taskMethod)(Args...), Class* taskObj, TaskGroup taskGroup = 0, TaskStopTimeout taskStopTimeout = kDefaultStopTimeout);
+
+    template <typename Class, typename R, typename... Args>
+    void registerTask(TaskType taskType, R (Class::*taskMethod)(Args...) const, Class* taskObj, TaskGroup taskGroup = 0, TaskStopTimeout taskStopTimeout = kDefaultStopTimeout);
+
+    // More generic overload (for lambdas, functors, results of std::bind)
+    template <typename F>
+    void registerTask(TaskType taskType, F&& taskFunction, TaskGroup taskGroup = 0, TaskStopTimeout taskStopTimeout = kDefaultStopTimeout);
+
+    // Registers StaticTask definitions; duplicate ids within the list fail to compile. They are also
+    // visible to the runtime API (addTask(type, ...), per-type settings, cancelTaskByType, ...).
+    template <typename... Definitions>
+    void registerStaticTasks();
+
+    bool unregisterTask(TaskType taskType);
+    bool setTaskArgsCapture(TaskType taskType, ArgsCapture capture);
+    ArgsCapture taskArgsCapture(TaskType taskType) const;
+    bool setTaskResultDelivery(TaskType taskType, ResultDelivery delivery);
+    ResultDelivery taskResultDelivery(TaskType taskType) const;
+    void setResultFlushInterval(int intervalMs);
+    int resultFlushInterval() const;
+    void shutdown(QDeadlineTimer deadline);
+    // Moves the Core, with its queues and timers, to an internal thread so scheduling does not wait on
+    // a busy GUI loop. Signals still reach receivers on their own threads. Afterwards that internal thread
+    // is the owner thread: use postTask/postCancelTaskById or QMetaObject::invokeMethod from elsewhere.
+    bool startSchedulerThread();
+    bool hasSchedulerThread() const;
+    bool isShuttingDown() const;
+    void setShutdownTimeout(int timeoutMs);
+    int shutdownTimeout() const;
+    void setGroupConcurrency(TaskGroup group, int maxActiveTasks);
+    int groupConcurrency(TaskGroup group) const;
+    // Token bucket: tasks of the group start at most tasksPerSecond on average, with bursts of up to
+    // burst tasks. Held tasks stay queued without a thread. kUnlimitedGroupRate removes the limit.
+    bool setGroupRateLimit(TaskGroup group, double tasksPerSecond, int burst = 1);
+    double groupRateLimit(TaskGroup group) const;
+    int groupRateBurst(TaskGroup group) const;
+    // Keeps at most maxInMemoryTasks queued tasks of the group in memory; further tasks are appended to
+    // filePath and read back as the queue drains. A file left by an earlier process is resumed.
+    // maxInMemoryTasks <= 0 reads every spilled task back into memory and stops spilling.
+    bool setGroupQueueSpill(TaskGroup group, int maxInMemoryTasks, const QString& filePath);
+    qint64 spilledTaskCount(TaskGroup group) const;
+    // Applies to threads started for the group afterwards; a default TaskThreadPolicy removes it.
+    // Fails while the group has active tasks.
+    bool setGroupThreadPolicy(TaskGroup group, const TaskThreadPolicy& policy);
+    TaskThreadPolicy groupThreadPolicy(TaskGroup group) const;
+
+    template <typename... Args>
+    void addTask(TaskType taskType, Args&&... args);
+    // Statically typed form for a registered StaticTask, e.g. addTask<ResizeTask>(image, 640).
+    template <typename Definition, typename... Args>
+    std::enable_if_t<core_detail::isStaticTask<Definition>> addTask(Args&&... args);
+
+    template <typename... Args>
+    void addTaskWithPriority(TaskType taskType, TaskPriority priority, Args&&... args);
+    // The task is useful until deadline (a TTL is QDeadlineTimer(ttlMs)): if it has not started by then it is
+    // dropped with expiredTask instead, and if it is still running it is stopped like stopTaskById.
+    template <typename... Args>
+    void addTaskWithDeadline(TaskType taskType, QDeadlineTimer deadline, Args&&... args);
+    // token.cancel(), or cancel() on any of its ancestors, stops the task cooperatively, or drops it if
+    // it has not started yet. The owner thread does no per-task work for it.
+    template <typename... Args>
+    void addTaskWithToken(const TaskCancellationToken& token, TaskType taskType, Args&&... args);
+
+    // Thread-safe, e.g. for follow-up work from a task: the task is added on the owner thread's next
+    // event-loop turn under the returned id. Errors are logged there instead of thrown.
+    template <typename... Args>
+    TaskId postTask(TaskType taskType, Args&&... args);
+    template <typename... Args>
+    TaskId postTaskWithPriority(TaskType taskType, TaskPriority priority, Args&&... args);
+    // Thread-safe: drops the task if it is still queued, otherwise acts like cancelTaskById.
+    void postCancelTaskById(TaskId id);
+
+    // R must be the registered return type, e.g. addTaskWithHandle<int>(type, 21).
+    template <typename R, typename... Args>
+    TaskHandle<R> addTaskWithHandle(TaskType taskType, Args&&... args);
+    // Starts the task once every dependency has finished; cancelTaskById on any of them cancels it.
+    template <typename R, typename... Args>
+    TaskHandle<R> addTaskAfter(const QVector<TaskDependency>& dependencies, TaskType taskType, Args&&... args);
+
+    // Pipeline stages are long-lived tasks that move items between TaskChannels until input runs dry.
+    // In = void registers a source (transform returns std::optional<Out>, empty ends it); Out = void a sink.
+    // Every instance calls its own copy of transform, so it may keep state without locking.
+    template <typename In, typename Out, typename F>
+    void registerPipelineStage(TaskType taskType, F&& transform, TaskGroup taskGroup = 0, TaskStopTimeout taskStopTimeout = kDefaultStopTimeout);
+    template <typename In, typename Out>
+    void addPipelineStage(TaskType taskType, TaskChannel<In> input, TaskChannel<Out> output, int instances = 1);
+    template <typename In>
+    void addPipelineSink(TaskType taskType, TaskChannel<In> input, int instances = 1);
+    template <typename Out>
+    void addPipelineSource(TaskType taskType, TaskChannel<Out> output, int instances = 1);
+
+    // Data-parallel tasks over an index range [begin, end), split into chunks of grainSize (0 picks one).
+    // In WorkerPool mode idle workers help with the chunks; map and reduce must be thread-safe and
+    // reduce associative and commutative. A single finishedTask carries the reduced result.
+    template <typename R, typename Map, typename Reduce>
+    void registerMapReduce(TaskType taskType, Map&& map, Reduce&& reduce, R identity = R(), qint64 grainSize = 0, TaskGroup taskGroup = 0, TaskStopTimeout taskStopTimeout = kDefaultStopTimeout);
+    template <typename F>
+    void registerParallelFor(TaskType taskType, F&& body, qint64 grainSize = 0, TaskGroup taskGroup = 0, TaskStopTimeout taskStopTimeout = kDefaultStopTimeout);
+    TaskId addParallelTask(TaskType taskType, qint64 begin, qint64 end);
+
+    bool setTaskPriority(TaskType taskType, TaskPriority priority);
+    TaskPriority taskPriority(TaskType taskType) const;
+    // For pure task types: the last maxEntries results are kept per argument list (0 disables),
+    // and an addTask with the same arguments as a queued or running task waits for that task instead.
+    bool setTaskResultCaching(TaskType taskType, int maxEntries);
+    int taskResultCaching(TaskType taskType) const;
+
+    // Off by default; when off the scheduler only tests a null pointer per event.
+    void setMetricsEnabled(bool enabled);
+    bool isMetricsEnabled() const;
+    MetricsSnapshot metricsSnapshot() const;
+    void resetMetrics();
+
+    // Records queue insertion and TaskState transitions into one lock-free ring of eventCapacity
+    // entries; chromeTraceJson() renders them for chrome://tracing or Perfetto.
+    void setTracingEnabled(bool enabled, int eventCapacity = kDefaultTraceEventCapacity);
+    bool isTracingEnabled() const;
+    QByteArray chromeTraceJson() const;
+    void setPriorityAging(int aging);
+    int priorityAging() const;
+
+    // Range of std::tuple<Args...>, one tuple per task; an rvalue range has its tuples moved from.
+    template <typename Range>
+    TaskIdRange addTasks(TaskType taskType, Range&& argsTuples);
+
+    std::atomic_bool* stopTaskFlag();
+    void cancelTaskById(TaskId id);
+    void cancelTaskByType(TaskType type);
+    void cancelTaskByGroup(TaskGroup group);
+    void cancelTasks();
+    void cancelAllTasks();
+    void cancelTasksByGroup(TaskGroup group, bool includeQueued);
+    void terminateTaskById(TaskId id);
+    void setAllowForceTermination(bool allow);
+    bool allowForceTermination() const;
+    bool setExecutionMode(ExecutionMode mode, int workerCount = 0);
+    bool setAdaptiveWorkerPool(int minWorkers, int maxWorkers, int idleTimeoutMs = kDefaultWorkerIdleTimeout);
+    ExecutionMode executionMode() const;
+    int workerCount() const;
+    void stopTaskById(TaskId id);
+    void stopTaskByType(TaskType type);
+    void stopTaskByGroup(TaskGroup group);
+    void stopTasks();
+    void stopAllTasks();
+    void stopTasksByGroup(TaskGroup group, bool includeQueued);
+    bool isTaskRegistered(TaskType type);
+    TaskGroup groupByTask(TaskType type, bool* ok = nullptr);
+    bool isIdle();
+    bool isTaskAddedByType(TaskType type, bool* isActive = nullptr);
+    bool isTaskAddedByGroup(TaskGroup group, bool* isActive = nullptr);
+
+private:
+    enum class TaskState {
+        Inactive,
+        Active,
+        StopRequested,
+        StopTimedOut,
+        Finished,
+        Terminated
+    };
+
+    // Registered callables are stored as TaskFunctionPtr<Args...>, shared by every task bound to them.
+    template <typename... Args>
+    using TaskFunctionPtr = QSharedPointer<std::function<QVariant(Args...)>>;
+    // The same callable with its own return type, used by addTaskWithHandle.
+    template <typename R, typename... Args>
+    using TypedTaskFunctionPtr = QSharedPointer<std::function<R(Args...)>>;
+
+    // LRU of finished results, keyed on the serialized arguments, plus the duplicates attached to runs in flight.
+    struct ResultCache {
+        explicit ResultCache(int maxEntries)
+            : m_results(maxEntries) {}
+
+        QCache<QByteArray, QVariant> m_results;
+        QHash<QByteArray, QVector<TaskId>> m_inFlight; // key -> duplicate ids waiting for that run
+    };
+
+    // A duplicate attached to a run in flight; it has no task record of its own until a run is handed to it.
+    struct CacheDuplicate {
+        QSharedPointer<ResultCache> m_pCache;
+        QByteArray m_cacheKey;
+        TaskType m_type;
+        TaskGroup m_group;
+        QList<QVariant> m_argsList;
+    };
+
+    struct TaskInfo {
+        std::any m_function; // TaskFunctionPtr<Args...>
+        std::any m_typedFunction; // TypedTaskFunctionPtr<R, Args...>
+        TaskGroup m_group;
+        TaskStopTimeout m_stopTimeout;
+        ArgsCapture m_argsCapture = ArgsCapture::Eager;
+        ResultDelivery m_resultDelivery = ResultDelivery::PerTask;
+        TaskPriority m_priority = kDefaultTaskPriority;
+        QSharedPointer<ResultCache> m_pResultCache = {}; // set by setTaskResultCaching
+        const void* m_pStaticDefinition = nullptr; // StaticTask::registrationTag, set by registerStaticTasks
+        int m_argCount = 0;
+        // Rebuilds the call from captured arguments; empty if they do not convert back. Null when the
+        // parameters are not QVariant-convertible, so such tasks are never spilled.
+        std::function<std::function<QVariant()>(const QList<QVariant>&)> m_restoreFunction = {};
+    };
+
+    struct Task {
+        Task(TaskId id, TaskType type, TaskGroup group, QList<QVariant> argsList = {})
+            : m_id(id)
+            , m_type(type)
+            , m_group(group)
+            , m_argsList(std::move(argsList))
+            , m_state(TaskState::Inactive) {}
+        virtual ~Task() {
+            // A task that never delivered its result leaves its handle canceled rather than pending forever.
+            if (m_pHandleState) {
+                m_pHandleState->cancel();
+            }
+            if (m_pCancellation) {
+                m_pCancellation->unregisterStopFlag(&m_stopFlag);
+            }
+        }
+
+        // Invoked exactly once, on the thread that executes the task.
+        virtual QVariant run() = 0;
+
+        QVariant execute() {
+            if (!m_timed && !m_pTracer) {
+                return run();
+            }
+            // A pooled task may still wait behind other work in its pool, so it starts only here.
+            if (m_pooled) {
+                trace(core_detail::TraceEventKind::Started);
+            }
+            trace(core_detail::TraceEventKind::RunBegin);
+            if (m_timed) {
+                m_runStartUs.store(core_detail::steadyMicros());
+            }
+            QVariant result = run();
+            if (m_timed) {
+                m_runEndUs.store(core_detail::steadyMicros());
+            }
+            trace(core_detail::TraceEventKind::RunEnd);
+            return result;
+        }
+
+        void trace(core_detail::TraceEventKind kind) const {
+            if (m_pTracer) {
+                m_pTracer->record(kind, m_id, m_type, m_group);
+            }
+        }
+
+        TaskId m_id;
+        TaskType m_type;
+        TaskGroup m_group;
+        QList<QVariant> m_argsList;
+    #ifdef Q_OS_WIN
+        HANDLE m_threadHandle = nullptr;
+        HANDLE m_exitWaitHandle = nullptr; // RegisterWaitForSingleObject watch armed by terminateTask
+        DWORD m_threadId = 0;
+    #else
+        pthread_t m_threadHandle = 0;
+    #endif
+        std::atomic_bool m_stopFlag{false};
+        std::atomic_bool m_threadExited{false};
+        bool m_pooled = false; // executed by a TaskWorkerPool worker, no dedicated thread handle
+        TaskPriority m_priority = kDefaultTaskPriority;
+        qint64 m_queueRank = 0; // with m_priority and m_id, the key of the task in its group queue
+        QDeadlineTimer m_deadline{QDeadlineTimer::Forever}; // set by addTaskWithDeadline
+        QSharedPointer<core_detail::CancellationNode> m_pCancellation; // set by addTaskWithToken
+        QSharedPointer<core_detail::TaskHandleStateBase> m_pHandleState; // set by addTaskWithHandle
+        QSharedPointer<ResultCache> m_pResultCache; // kept even if caching is turned off meanwhile
+        QByteArray m_cacheKey;
+        // Timestamps for metrics, taken only when m_timed is set at admission.
+        bool m_timed = false;
+        qint64 m_admittedUs = 0;
+        qint64 m_stopRequestedUs = 0;
+        std::atomic<qint64> m_runStartUs{0};
+        std::atomic<qint64> m_runEndUs{0};
+        QSharedPointer<core_detail::TaskTracer> m_pTracer; // set at admission while tracing is on
+        QSharedPointer<const TaskThreadPolicy> m_pThreadPolicy; // set by startTask for a dedicated thread
+        TaskState m_state;
+    };
+
+    // Keeps the bound callable (function plus moved-in arguments) in the same allocation as the task record.
+    template <typename F>
+    struct BoundTask final : Task {
+        BoundTask(F function, TaskId id, TaskType type, TaskGroup group, QList<QVariant> argsList)
+            : Task(id, type, group, std::move(argsList))
+            , m_function(std::move(function)) {}
+
+        QVariant run() override {
+            return m_function();
+        }
+
+        F m_function;
+    };
+
+    // A recycled TaskHelper and the task it currently runs; the finished connection is made once per slot.
+    struct TaskHelperSlot {
+        TaskHelper* m_pHelper = nullptr;
+        QSharedPointer<Task> m_pTask;
+    };
+
+    // Append-only file of queued tasks: a header with the offset of the first record not yet read back,
+    // then records of a little-endian quint32 size and a QDataStream payload.
+    struct GroupSpill {
+        QSharedPointer<QFile> m_pFile;
+        int m_maxInMemoryTasks = 0;
+        qint64 m_readOffset = 0;   // first record not yet read back
+        qint64 m_writeOffset = 0;  // end of the last complete record
+        qint64 m_resumedEnd = 0;   // records before this offset were written by an earlier process
+        qint64 m_pendingRecords = 0;
+    };
+    struct SpillRecord {
+        TaskId m_id = 0;
+        TaskType m_type = 0;
+        TaskPriority m_priority = kDefaultTaskPriority;
+        qint64 m_admittedUs = 0;
+        QList<QVariant> m_argsList;
+        bool m_resumed = false;
+    };
+    static constexpr quint32 kSpillMagic = 0x53515443; // "CTQS"
+    static constexpr quint32 kSpillVersion = 1;
+    static constexpr qint64 kSpillHeaderSize = 16;
+    static constexpr qint64 kSpillCompactBytes = 8 * 1024 * 1024; // consumed prefix worth a rewrite
+
+    // Per-call settings of addTask and its variants.
+    struct AddTaskOptions {
+        std::optional<TaskPriority> m_priority;
+        std::optional<TaskId> m_presetId;     // id already handed out by postTask
+        QDeadlineTimer m_deadline{QDeadlineTimer::Forever};
+        QSharedPointer<core_detail::CancellationNode> m_pCancellation;
+    };
+
+    // Group queues are ordered by rank = enqueue tick - priority * aging, then by priority and id.
+    // A higher priority is a bounded head start rather than an absolute one: a waiting task is overtaken
+    // only by tasks enqueued at most (priority difference * aging) ticks after it, so starvation stays bounded.
+    struct QueueKey {
+        qint64 m_rank;
+        TaskPriority m_priority;
+        TaskId m_id;
+
+        bool operator<(const QueueKey& other) const {
+            if (m_rank != other.m_rank) {
+                return m_rank < other.m_rank;
+            }
+            return (m_priority != other.m_priority) ? (m_priority > other.m_priority) : (m_id < other.m_id);
+        }
+    };
+    using GroupQueue = QMap<QueueKey, QSharedPointer<Task>>;
+
+    // Stop windows, stop timeouts, terminate confirmations and task deadlines share one min-heap and one QTimer.
+    enum class DeadlineKind {
+        StopTimeout,        // cooperative stop window of a task has elapsed
+        TerminateTimeout,   // forced termination was not confirmed in time
+        ResumeStarts,       // stop window of stopTasks has elapsed
+        ShutdownEscalation, // cooperative half of the shutdown budget has elapsed
+        ShutdownDeadline,   // shutdown budget has elapsed
+        TaskDeadline,       // useful-by time of a queued or running task has passed
+        RateRefill          // the token bucket of a group (m_taskId) has a token again
+    };
+
+    enum class ShutdownState {
+        Running,
+        ShuttingDown,
+        ShutDown
+    };
+
+    struct Deadline {
+        qint64 m_dueMs;
+        DeadlineKind m_kind;
+        TaskId m_taskId;
+        TaskStopTimeout m_timeout;
+
+        bool operator>(const Deadline& other) const { return m_dueMs > other.m_dueMs; }
+    };
+
+#ifdef Q_OS_WIN
+    struct ThreadExitWatch {
+        Core* m_pCore;
+        TaskId m_taskId;
+    };
+    static VOID CALLBACK threadHandleSignaled(PVOID pContext, BOOLEAN timedOut);
+#endif
+
+    template <typename F>
+    QSharedPointer<Task> createTask(F&& function, TaskId id, TaskType type, TaskGroup group, QList<QVariant> argsList);
+
+    template <typename... Args>
+    void addTaskImpl(TaskType taskType, AddTaskOptions options, Args&&... args);
+    // Shared tail of the addTask forms: result caching, task creation and admission.
+    template <typename F>
+    void admitBoundTask(const TaskInfo& taskInfo, TaskType taskType, AddTaskOptions options,
+                        QList<QVariant> argsList, int argCount, F&& function);
+    template <typename... Args>
+    TaskId postTaskImpl(TaskType taskType, std::optional<TaskPriority> priority, Args&&... args);
+    void drainSubmissions();
+    QSharedPointer<Task> takeQueuedTask(TaskId id);
+    bool removeQueuedTask(const QSharedPointer<Task>& pTask);
+    void onTaskDeadline(TaskId taskId);
+    void scheduleTaskDeadline(const Task& task);
+
+    template <typename... Args>
+    QList<QVariant> captureArgs(const TaskInfo& taskInfo, TaskType taskType, const Args&... args) const;
+    void admitTask(QSharedPointer<Task> pTask);
+    void recordTaskAdmitted(Task& task, qint64 admittedUs, bool countAdded);
+    template <typename R, typename... Args>
+    QSharedPointer<Task> createHandleTask(const char* warningPrefix, TaskType taskType, Args&&... args);
+    void releaseWaitingTask(TaskId taskId);
+    void countWaitingTask(const Task& task, int delta);
+    void warnIfStageExceedsGroup(const char* warningPrefix, TaskType taskType, int instances) const;
+    void cancelWaitingTask(TaskId taskId);
+    void cancelDependentTasks(TaskId taskId);
+    void detachFromDependencies(TaskId taskId, const QVector<TaskId>& dependencies);
+
+    template <typename Range, typename... Args>
+    TaskIdRange addTasksImpl(TaskType taskType, Range&& argsTuples, std::tuple<Args...>*);
+
+    // Shared by every Core, so ids stay unique process-wide; a batch reserves its whole range at once.
+    static TaskId reserveTaskIds(TaskId count);
+    static inline std::atomic<TaskId> s_nextTaskId{0};
+
+    QSharedPointer<Task> activeTaskById(TaskId id);
+    QSharedPointer<Task> activeTaskByType(TaskType type);
+    QSharedPointer<Task> activeTaskByGroup(TaskGroup group);
+
+    void terminateTask(QSharedPointer<Task> pTask);
+    void stopTask(QSharedPointer<Task> pTask);
+    void startTask(QSharedPointer<Task> pTask);
+    int acquireTaskHelperSlot();
+    void releaseTaskHelperSlot(int slotIndex);
+    void onTaskHelperFinished(int slotIndex, QVariant result);
+    void scheduleFinishedTasksFlush();
+    void scheduleDeadline(DeadlineKind kind, TaskId taskId, TaskStopTimeout timeout);
+    void scheduleDeadline(DeadlineKind kind, TaskId taskId, const QDeadlineTimer& deadline);
+    void armDeadlineTimer();
+    void processDeadlines();
+    void onStopTimeout(TaskId taskId, TaskStopTimeout timeout);
+    void onTerminateTimeout(TaskId taskId, TaskStopTimeout timeout);
+    void onTaskThreadExited(TaskId taskId);
+#ifndef Q_OS_WIN
+    TaskThreadExitQueue* threadExitQueue();
+    void onTaskThreadsExited();
+#endif
+    void reportTerminated(const QSharedPointer<Task>& pTask);
+    void reportDroppedTask(const QSharedPointer<Task>& pTask);
+    void reportExpiredTask(const QSharedPointer<Task>& pTask);
+    void reportStopTimedOut(const QSharedPointer<Task>& pTask, TaskStopTimeout timeout);
+    template <typename F>
+    void updateMetrics(const Task& task, F&& update);
+    void recordTaskStarted(const Task& task);
+    void recordTaskEnded(const Task& task, bool finished);
+    static QByteArray resultCacheKey(const QList<QVariant>& argsList, int argCount);
+    void deliverCachedResult(TaskId id, TaskType taskType, const QList<QVariant>& argsList, const QVariant& result, ResultDelivery delivery);
+    void resolveCacheWaiters(const QSharedPointer<Task>& pTask, const QVariant* pResult, QVector<TaskResult>* pBatch);
+    bool handOffCachedRun(const QSharedPointer<Task>& pTask, const QByteArray& cacheKey, QVector<TaskId>& waiters);
+    bool dropCacheDuplicate(TaskId id);
+    void dropCacheDuplicates(std::optional<TaskGroup> group);
+    void resumeStarts();
+    void finishShutdown();
+    void shutdownForDestruction();
+    void waitForShutdownWithoutDispatcher();
+    void flushFinishedTasks();
+    void startQueuedTask(TaskGroup group);
+    void startQueuedTasks();
+    void insertActiveTask(const QSharedPointer<Task>& pTask);
+    void removeActiveTask(const QSharedPointer<Task>& pTask);
+    void enqueueTask(QSharedPointer<Task> pTask);
+    void releaseQueuedTask(const QSharedPointer<Task>& pTask);
+    QList<QSharedPointer<Task>> takeQueuedTasks(TaskGroup group);
+    QList<QSharedPointer<Task>> takeQueuedTasks();
+    bool isGroupBusy(TaskGroup group) const;
+    bool takeRateToken(TaskGroup group, bool bypassQueue);
+    void returnRateToken(TaskGroup group);
+    bool isSpillCaptureNeeded(TaskGroup group) const;
+    bool openGroupSpill(TaskGroup group, GroupSpill& spill, const QString& filePath);
+    bool spillTask(const QSharedPointer<Task>& pTask);
+    void writeSpillHeader(GroupSpill& spill);
+    static void encodeSpillHeader(qint64 readOffset, uchar* pHeader);
+    void compactSpillFile(GroupSpill& spill);
+    template <typename F>
+    void readSpillRecords(GroupSpill& spill, qint64 maxRecords, F&& visit);
+    QSharedPointer<Task> restoreSpilledTask(TaskGroup group, SpillRecord record, bool decoded, bool* pRunnable);
+    void refillSpilledTasks(TaskGroup group, bool drainAll = false);
+    void discardSpilledTasks(TaskGroup group);
+    void insertQueuedTask(QSharedPointer<Task> pTask);
+    bool isArgsCaptureNeeded(ArgsCapture capture) const;
+    bool ensureCalledFromOwnerThread(const char* method) const;
+    bool installWorkerPool(std::unique_ptr<TaskWorkerPool> pWorkerPool, const char* methodName);
+
+    template <typename... Args>
+    void insertToTaskHash(TaskType taskType, std::function<QVariant(Args...)> taskFunction, TaskGroup taskGroup = 0, TaskStopTimeout taskStopTimeout = kDefaultStopTimeout, std::any typedFunction = {});
+    template <typename... Args, std::size_t... Indexes>
+    static std::function<QVariant()> bindSpilledArgs(const TaskFunctionPtr<Args...>& pFunction, const QList<QVariant>& argsList,
+                                                     std::index_sequence<Indexes...>);
+
+    QHash<TaskType, TaskInfo> m_taskHash;
+    // Active tasks are indexed by id, type and group; a group is busy while its entry exists.
+    QHash<TaskId, QSharedPointer<Task>> m_activeTasks;
+    QHash<TaskType, QMap<TaskId, QSharedPointer<Task>>> m_activeTasksByType;
+    QHash<TaskGroup, QMap<TaskId, QSharedPointer<Task>>> m_activeTasksByGroup;
+    // Queued tasks wait per group, ordered by QueueKey: priority with aging, then id. Only groups
+    // with waiting tasks have an entry.
+    QHash<TaskGroup, GroupQueue> m_queuedTasksByGroup;
+    qint64 m_queueTick = 0;
+    int m_priorityAging = kDefaultPriorityAging;
+    QHash<TaskType, int> m_queuedCountByType;
+    int m_queuedTaskCount = 0;
+    QHash<TaskId, QWeakPointer<Task>> m_deadlineTasks; // tasks with a TaskDeadline entry in m_deadlines
+    QHash<TaskId, CacheDuplicate> m_cacheDuplicates; // by duplicate id, mirrors ResultCache::m_inFlight
+
+    // Tasks added with addTaskAfter whose dependencies have not all finished yet.
+    struct WaitingTask {
+        QSharedPointer<Task> m_pTask;
+        QVector<TaskId> m_dependencies;
+    };
+    // Task-thread continuations post to the Core through this link, which the destructor cuts.
+    struct OwnerLink {
+        std::mutex m_mutex;
+        Core* m_pCore = nullptr;
+    };
+    QHash<TaskId, WaitingTask> m_waitingTasks;
+    QHash<TaskType, int> m_waitingCountByType; // like m_queuedCountByType, for m_waitingTasks
+    QHash<TaskGroup, int> m_waitingCountByGroup;
+    QHash<TaskId, QVector<TaskId>> m_dependentTasks; // dependency id -> waiting task ids
+    QSharedPointer<OwnerLink> m_pOwnerLink;
+    QHash<TaskGroup, int> m_groupConcurrency; // groups without an entry use kDefaultGroupConcurrency
+    struct GroupRateLimit {
+        double m_tasksPerSecond = kUnlimitedGroupRate;
+        int m_burst = 1;
+        double m_tokens = 0.0;
+        qint64 m_refilledUs = 0;
+        bool m_refillScheduled = false;
+    };
+    QHash<TaskGroup, GroupRateLimit> m_groupRateLimits; // groups without an entry are not throttled
+    QHash<TaskGroup, GroupSpill> m_groupSpills;
+    std::atomic_bool m_blockStartTask{false};
+    bool m_allowForceTermination = false;
+    ExecutionMode m_executionMode = ExecutionMode::DedicatedThreads;
+    std::unique_ptr<TaskWorkerPool> m_pWorkerPool;
+    QHash<TaskGroup, QSharedPointer<const TaskThreadPolicy>> m_groupThreadPolicies; // numaNode resolved to CPUs
+    QHash<TaskGroup, QSharedPointer<TaskWorkerPool>> m_groupWorkerPools; // WorkerPool mode, dedicatedWorkers > 0
+    QVector<TaskHelperSlot> m_taskHelperSlots;
+    QVector<int> m_idleTaskHelperSlots;
+    TaskCompletionQueue m_completionQueue;
+    TaskSubmissionQueue m_submissionQueue; // postTask/postCancelTaskById from any thread
+    core_detail::TaskExitSignal m_taskExitSignal; // see waitForShutdownWithoutDispatcher
+#ifndef Q_OS_WIN
+    TaskThreadExitQueue m_threadExitQueue; // dedicated threads canceled by terminateTask
+    QSocketNotifier* m_pThreadExitNotifier = nullptr; // created with the first dedicated thread
+#endif
+    QThread* m_pSchedulerThread = nullptr;  // not a child: it stays with the thread that created it
+    // Every metric event happens on the owner thread, so plain counters suffice; the task threads only
+    // write their own run timestamps.
+    std::unique_ptr<MetricsSnapshot> m_pMetrics;
+    QSharedPointer<core_detail::TaskTracer> m_pTracer; // tasks keep theirs when tracing is turned off
+    QTimer* m_pResultFlushTimer = nullptr;
+    int m_resultFlushInterval = 0; // ms; 0 flushes on the next event-loop turn
+    std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>> m_deadlines;
+    QElapsedTimer m_deadlineClock;
+    QTimer* m_pDeadlineTimer = nullptr;
+    qint64 m_armedDeadlineMs = 0;
+    bool m_resumeStartsWhenIdle = false; // stopTasks window elapsed while tasks were still active
+    ShutdownState m_shutdownState = ShutdownState::Running;
+    int m_shutdownTimeout = kDefaultShutdownTimeout;
+    // Checked again when their deadline entries fire, since those hold at most INT_MAX ms.
+    QDeadlineTimer m_shutdownEscalation{QDeadlineTimer::Forever};
+    QDeadlineTimer m_shutdownDeadline{QDeadlineTimer::Forever};
+
+signals:
+    void finishedTask(TaskId id, TaskType type, QList<QVariant> argsList = {}, QVariant result = QVariant());
+    void finishedTasks(QVector<Core::TaskResult> results);
+    void startedTask(TaskId id, TaskType type, QList<QVariant> argsList = {});
+    void terminatedTask(TaskId id, TaskType type, QList<QVariant> argsList = {});
+    void expiredTask(TaskId id, TaskType type, QList<QVariant> argsList = {});
+    void stopRequestedTask(TaskId id, TaskType type, QList<QVariant> argsList = {});
+    void stopTimedOutTask(TaskId id, TaskType type, QList<QVariant> argsList = {}, TaskStopTimeout timeout = kDefaultStopTimeout);
+    void shutdownFinished(bool allTasksStopped);
+};
+
+Q_DECLARE_METATYPE(Core::TaskResult)
+
+// --- Class method implementations *after* class declarations ---
+
+// TaskHelper Implementation
+inline TaskHelper::TaskHelper(QObject* parent)
+    : QObject(parent) {}
+
+inline TaskHelper::TaskHelper(std::function<QVariant()> function, std::atomic_bool* pStopFlag, std::atomic_bool* pThreadExited, QObject* parent)
+    : QObject(parent), m_function(std::move(function)), m_pStopFlag(pStopFlag), m_pThreadExited(pThreadExited) {}
+
+inline TaskHelper::TaskHelper(int slotIndex, core_detail::TaskExitSignal* pExitSignal, QObject* parent)
+    : QObject(parent), m_slotIndex(slotIndex), m_pExitSignal(pExitSignal) {}
+
+inline void TaskHelper::bind(std::function<QVariant()> function, std::atomic_bool* pStopFlag, std::atomic_bool* pThreadExited,
+                             TaskCompletionQueue* pCompletionQueue, TaskThreadExitQueue* pThreadExitQueue) {
+    m_function = std::move(function);
+    m_pStopFlag = pStopFlag;
+    m_pThreadExited = pThreadExited;
+    m_pCompletionQueue = pCompletionQueue;
+    m_pThreadExitQueue = pThreadExitQueue;
+}
+
+inline int TaskHelper::slotIndex() const {
+    return m_slotIndex;
+}
+
+inline QVariant TaskHelper::takeResult() {
+    return std::exchange(m_result, QVariant());
+}
+
+inline void TaskHelper::markThreadExited() noexcept {
+    if (m_pThreadExited) {
+        m_pThreadExited->store(true);
+    }
+}
+
+inline void TaskHelper::execute() {
+    core_detail::g_currentStopFlag = m_pStopFlag;
+    QVariant result;
+    try {
+        result = m_function();
+    } catch (...) {
+        core_detail::g_currentStopFlag = nullptr;
+        markThreadExited();
+        throw;
+    }
+    core_detail::g_currentStopFlag = nullptr;
+#ifndef Q_OS_WIN
+    // The helper is handed back below; a late pthread_cancel must not run the exit cleanup after that.
+    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, nullptr);
+#endif
+    markThreadExited();
+    core_detail::TaskExitSignal* pExitSignal = m_pExitSignal;
+    if (m_pCompletionQueue) {
+        m_result = std::move(result);
+        m_pCompletionQueue->push(this); // the helper may be rebound right after this call
+    } else {
+        emit finished(result);
+    }
+    // After the completion is posted, so a woken destructor finds it.
+    if (pExitSignal) {
+        pExitSignal->notify();
+    }
+}
+
+#ifdef Q_OS_WIN
+inline DWORD TaskHelper::functionWrapper(void* pTaskHelper) {
+    TaskHelper *pThisTaskHelper = qobject_cast<TaskHelper *>(reinterpret_cast<QObject *>(pTaskHelper));
+    if (pThisTaskHelper) pThisTaskHelper->execute();
+    return 0;
+}
+#else
+inline void TaskHelper::cleanupThreadExit(void* pTaskHelper) noexcept {
+    TaskHelper *pThisTaskHelper = reinterpret_cast<TaskHelper *>(pTaskHelper);
+    if (pThisTaskHelper) {
+        // The thread may be canceled anywhere, even holding a malloc lock: only lock-free stores from here.
+        pThisTaskHelper->markThreadExited();
+        if (pThisTaskHelper->m_pThreadExitQueue) {
+            pThisTaskHelper->m_pThreadExitQueue->push(pThisTaskHelper);
+        }
+    }
+}
+
+inline void* TaskHelper::functionWrapper(void* pTaskHelper) {
+#if defined(PTHREAD_CANCEL_ENABLE) && defined(PTHREAD_CANCEL_ASYNCHRONOUS)
+    // Terminate path uses pthread_cancel; asynchronous cancellation makes forced stop predictable
+    // for non-cooperative tasks (terminateTaskById), while cooperative stop remains unchanged.
+    pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, nullptr);
+    pthread_setcanceltype(PTHREAD_CANCEL_ASYNCHRONOUS, nullptr);
+#endif
+    TaskHelper *pThisTaskHelper = reinterpret_cast<TaskHelper *>(pTaskHelper);
+    if (pThisTaskHelper) {
+        pthread_cleanup_push(&TaskHelper::cleanupThreadExit, pThisTaskHelper);
+        pThisTaskHelper->execute();
+        // execute() already marked the exit; the helper may be rebound as soon as finished is emitted.
+        pthread_cleanup_pop(0);
+    }
+    return nullptr;
+}
+#endif
+
+// TaskCompletionQueue Implementation
+inline TaskCompletionQueue::TaskCompletionQueue(std::function<void()> notifier)
+    : m_notifier(std::move(notifier)) {}
+
+inline void TaskCompletionQueue::push(TaskHelper* pHelper) noexcept {
+    TaskHelper* pHead = m_pHead.load(std::memory_order_relaxed);
+    do {
+        pHelper->m_pNextCompleted = pHead;
+    } while (!m_pHead.compare_exchange_weak(pHead, pHelper, std::memory_order_release, std::memory_order_relaxed));
+
+    if (pHead == nullptr) {
+        m_notifier();
+    }
+}
+
+inline QVector<TaskHelper*> TaskCompletionQueue::takeAll() {
+    QVector<TaskHelper*> helpers;
+    for (TaskHelper* pHelper = m_pHead.exchange(nullptr, std::memory_order_acquire); pHelper != nullptr; pHelper = pHelper->m_pNextCompleted) {
+        helpers.append(pHelper);
+    }
+    std::reverse(helpers.begin(), helpers.end());
+    return helpers;
+}
+
+#ifndef Q_OS_WIN
+inline TaskThreadExitQueue::~TaskThreadExitQueue() {
+    for (int fd : m_pipe) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+}
+
+inline bool TaskThreadExitQueue::open() {
+    if (m_pipe[0] >= 0) {
+        return true;
+    }
+    int fds[2];
+    if (::pipe(fds) != 0) {
+        return false;
+    }
+    for (int fd : fds) {
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+        ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    m_pipe[0] = fds[0];
+    m_pipe[1] = fds[1];
+    return true;
+}
+
+inline int TaskThreadExitQueue::readDescriptor() const {
+    return m_pipe[0];
+}
+
+inline void TaskThreadExitQueue::push(TaskHelper* pHelper) noexcept {
+    TaskHelper* pHead = m_pHead.load(std::memory_order_relaxed);
+    do {
+        pHelper->m_pNextExited = pHead;
+    } while (!m_pHead.compare_exchange_weak(pHead, pHelper, std::memory_order_release, std::memory_order_relaxed));
+
+    // A full pipe already holds a pending wake-up, so a failed write loses nothing.
+    if (pHead == nullptr) {
+        const char byte = 0;
+        [[maybe_unused]] const ssize_t written = ::write(m_pipe[1], &byte, 1);
+    }
+}
+
+inline QVector<TaskHelper*> TaskThreadExitQueue::takeAll() {
+    // Drain before taking the list: a push after this either lands in the taken list or writes again.
+    char buffer[64];
+    while (::read(m_pipe[0], buffer, sizeof(buffer)) > 0) {
+    }
+    QVector<TaskHelper*> helpers;
+    for (TaskHelper* pHelper = m_pHead.exchange(nullptr, std::memory_order_acquire); pHelper != nullptr; pHelper = pHelper->m_pNextExited) {
+        helpers.append(pHelper);
+    }
+    std::reverse(helpers.begin(), helpers.end());
+    return helpers;
+}
+#endif
+
+inline TaskSubmissionQueue::TaskSubmissionQueue(std::function<void()> notifier)
+    : m_notifier(std::move(notifier)) {}
+
+inline TaskSubmissionQueue::~TaskSubmissionQueue() {
+    for (Node* pNode = detachAll(); pNode != nullptr;) {
+        Node* pNext = pNode->m_pNext;
+        delete pNode;
+        pNode = pNext;
+    }
+}
+
+inline void TaskSubmissionQueue::push(std::function<void()> command) {
+    Node* pNode = new Node{std::move(command)};
+    Node* pHead = m_pHead.load(std::memory_order_relaxed);
+    do {
+        pNode->m_pNext = pHead;
+    } while (!m_pHead.compare_exchange_weak(pHead, pNode, std::memory_order_release, std::memory_order_relaxed));
+
+    if (pHead == nullptr) {
+        m_notifier();
+    }
+}
+
+inline std::vector<std::function<void()>> TaskSubmissionQueue::takeAll() {
+    std::vector<std::function<void()>> commands;
+    for (Node* pNode = detachAll(); pNode != nullptr;) {
+        commands.push_back(std::move(pNode->m_command));
+        Node* pNext = pNode->m_pNext;
+        delete pNode;
+        pNode = pNext;
+    }
+    std::reverse(commands.begin(), commands.end());
+    return commands;
+}
+
+inline TaskSubmissionQueue::Node* TaskSubmissionQueue::detachAll() {
+    return m_pHead.exchange(nullptr, std::memory_order_acquire);
+}
+
+// TaskWorkerPool Implementation
+inline TaskWorkerPool::SharedState::SharedState(int minWorkers, int maxWorkers, int idleTimeoutMs,
+                                                QSharedPointer<const TaskThreadPolicy> pThreadPolicy)
+    : m_minWorkers(minWorkers)
+    , m_maxWorkers(maxWorkers)
+    , m_targetRunnable(std::min(maxWorkers, std::max(minWorkers, QThread::idealThreadCount())))
+    , m_idleTimeoutMs(idleTimeoutMs)
+    , m_pThreadPolicy(std::move(pThreadPolicy)) {
+    m_queues.reserve(maxWorkers);
+    for (int i = 0; i < maxWorkers; ++i) {
+        m_queues.push_back(std::make_unique<WorkerQueue>());
+    }
+}
+
+inline bool TaskWorkerPool::SharedState::popLocal(int workerIndex, std::function<void()>& job) {
+    WorkerQueue& queue = *m_queues[workerIndex];
+    std::lock_guard<std::mutex> lock(queue.m_mutex);
+    if (queue.m_jobs.empty()) {
+        return false;
+    }
+    job = std::move(queue.m_jobs.front());
+    queue.m_jobs.pop_front();
+    m_pendingJobs.fetch_sub(1);
+    return true;
+}
+
+inline bool TaskWorkerPool::SharedState::steal(int thiefIndex, std::function<void()>& job) {
+    const int queueCount = static_cast<int>(m_queues.size());
+    for (int offset = 1; offset < queueCount; ++offset) {
+        WorkerQueue& victim = *m_queues[(thiefIndex + offset) % queueCount];
+        std::unique_lock<std::mutex> lock(victim.m_mutex, std::try_to_lock);
+        if (!lock.owns_lock() || victim.m_jobs.empty()) {
+            continue;
+        }
+        // Steal from the opposite end to the owner to keep the two apart.
+        job = std::move(victim.m_jobs.back());
+        victim.m_jobs.pop_back();
+        m_pendingJobs.fetch_sub(1);
+        return true;
+    }
+    return false;
+}
+
+inline TaskWorkerPool::TaskWorkerPool(int workerCount, QSharedPointer<const TaskThreadPolicy> pThreadPolicy)
+    : TaskWorkerPool(workerCount, workerCount, -1, std::move(pThreadPolicy)) {
+}
+
+inline TaskWorkerPool::TaskWorkerPool(int minWorkers, int maxWorkers, int idleTimeoutMs,
+                                      QSharedPointer<const TaskThreadPolicy> pThreadPolicy)
+    : m_pState(QSharedPointer<SharedState>::create(minWorkers, maxWorkers, idleTimeoutMs, std::move(pThreadPolicy))) {
+    m_pState->m_pSelf = m_pState;
+    std::lock_guard<std::mutex> lock(m_pState->m_growMutex);
+    for (int i = 0; i < minWorkers; ++i) {
+        startWorker(*m_pState, i);
+    }
+}
+
+inline TaskWorkerPool::~TaskWorkerPool() {
+    m_pState->m_shutdown.store(true);
+    for (const auto& pQueue : m_pState->m_queues) {
+        std::lock_guard<std::mutex> lock(pQueue->m_mutex);
+        pQueue->m_jobs.clear();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_pState->m_sleepMutex);
+    }
+    m_pState->m_wakeCondition.notify_all();
+}
+
+inline int TaskWorkerPool::workerCount() const {
+    return m_pState->m_liveWorkers.load();
+}
+
+inline int TaskWorkerPool::minWorkerCount() const {
+    return m_pState->m_minWorkers;
+}
+
+inline int TaskWorkerPool::maxWorkerCount() const {
+    return m_pState->m_maxWorkers;
+}
+
+inline void TaskWorkerPool::submit(std::function<void()> job) {
+    submitTo(*m_pState, std::move(job));
+}
+
+inline int TaskWorkerPool::currentPoolWorkerCount() {
+    return t_pCurrentPool ? t_pCurrentPool->m_liveWorkers.load() : 0;
+}
+
+// The calling worker keeps its pool state alive, so no ownership is needed here.
+inline bool TaskWorkerPool::submitToCurrentPool(std::function<void()> job) {
+    if (t_pCurrentPool == nullptr || t_pCurrentPool->m_shutdown.load()) {
+        return false;
+    }
+    submitTo(*t_pCurrentPool, std::move(job));
+    return true;
+}
+
+inline void TaskWorkerPool::beginBlocking() {
+    if (t_pCurrentPool == nullptr || t_blockingDepth++ > 0) {
+        return;
+    }
+    t_pCurrentPool->m_blockedWorkers.fetch_add(1);
+    growIfNeeded(*t_pCurrentPool);
+}
+
+inline void TaskWorkerPool::endBlocking() {
+    if (t_pCurrentPool == nullptr || t_blockingDepth == 0 || --t_blockingDepth > 0) {
+        return;
+    }
+    t_pCurrentPool->m_blockedWorkers.fetch_sub(1);
+}
+
+inline void TaskWorkerPool::submitTo(SharedState& state, std::function<void()> job) {
+    const int queueCount = static_cast<int>(state.m_queues.size());
+    // Keep follow-up work local to the submitting worker; spread external submissions.
+    const int queueIndex = (t_pCurrentPool == &state)
+        ? t_workerIndex
+        : static_cast<int>(state.m_nextQueue.fetch_add(1, std::memory_order_relaxed) % static_cast<unsigned>(queueCount));
+    {
+        WorkerQueue& queue = *state.m_queues[queueIndex];
+        std::lock_guard<std::mutex> lock(queue.m_mutex);
+        queue.m_jobs.push_back(std::move(job));
+    }
+    state.m_pendingJobs.fetch_add(1);
+    if (state.m_sleepingWorkers.load() > 0) {
+        std::lock_guard<std::mutex> lock(state.m_sleepMutex);
+        state.m_wakeCondition.notify_one();
+    }
+    growIfNeeded(state);
+}
+
+// Adds a worker while queued jobs outnumber idle workers and fewer than the target are runnable.
+inline void TaskWorkerPool::growIfNeeded(SharedState& state) {
+    // Full pools (every fixed-size one) leave on the first relaxed load.
+    if (state.m_liveWorkers.load(std::memory_order_relaxed) >= state.m_maxWorkers
+        || state.m_pendingJobs.load() <= state.m_sleepingWorkers.load()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(state.m_growMutex);
+    const int liveWorkers = state.m_liveWorkers.load();
+    if (state.m_shutdown.load() || liveWorkers >= state.m_maxWorkers
+        || liveWorkers - state.m_blockedWorkers.load() >= state.m_targetRunnable) {
+        return;
+    }
+    for (int i = 0; i < state.m_maxWorkers; ++i) {
+        if (!state.m_queues[i]->m_hasWorker) {
+            startWorker(state, i);
+            return;
+        }
+    }
+}
+
+inline bool TaskWorkerPool::startWorker(SharedState& state, int workerIndex) {
+    QSharedPointer<SharedState> pState = state.m_pSelf.toStrongRef();
+    if (!pState) {
+        return false;
+    }
+    const std::size_t stackSize = state.m_pThreadPolicy ? state.m_pThreadPolicy->stackSize : 0;
+    // Each worker owns its own reference to the shared state.
+    auto* pStartInfo = new WorkerStartInfo{std::move(pState), workerIndex};
+#ifdef Q_OS_WIN
+    HANDLE threadHandle = core_detail::createThread(stackSize, &TaskWorkerPool::workerEntry, pStartInfo, nullptr);
+    if (threadHandle == NULL) {
+        qWarning() << "TaskWorkerPool - Failed to create worker thread. GetLastError:" << GetLastError();
+        delete pStartInfo;
+        return false;
+    }
+    CloseHandle(threadHandle);
+#else
+    pthread_t threadHandle;
+    int result = core_detail::createThread(&threadHandle, stackSize, &TaskWorkerPool::workerEntry, pStartInfo);
+    if (result != 0) {
+        qWarning() << "TaskWorkerPool - Failed to create worker thread. Error code:" << result;
+        delete pStartInfo;
+        return false;
+    }
+    pthread_detach(threadHandle);
+#endif
+    state.m_queues[workerIndex]->m_hasWorker = true;
+    state.m_liveWorkers.fetch_add(1);
+    return true;
+}
+
+// Jobs pushed to the slot after it is released are drained by the remaining workers' stealing.
+inline bool TaskWorkerPool::retireWorker(SharedState& state, int workerIndex) {
+    if (state.m_liveWorkers.load() <= state.m_minWorkers) {
+        return false;
+    }
+    WorkerQueue& queue = *state.m_queues[workerIndex];
+    std::lock_guard<std::mutex> lock(queue.m_mutex);
+    if (!queue.m_jobs.empty()) {
+        return false;
+    }
+    queue.m_hasWorker = false;
+    state.m_liveWorkers.fetch_sub(1);
+    return true;
+}
+
+#ifdef Q_OS_WIN
+inline DWORD TaskWorkerPool::workerEntry(void* pStartInfo) {
+#else
+inline void* TaskWorkerPool::workerEntry(void* pStartInfo) {
+#endif
+    auto* pThisStartInfo = reinterpret_cast<WorkerStartInfo*>(pStartInfo);
+    if (pThisStartInfo->m_pState->m_pThreadPolicy) {
+        core_detail::applyCurrentThreadPolicy(*pThisStartInfo->m_pState->m_pThreadPolicy);
+    }
+    runWorker(pThisStartInfo->m_pState, pThisStartInfo->m_workerIndex);
+    delete pThisStartInfo;
+#ifdef Q_OS_WIN
+    return 0;
+#else
+    return nullptr;
+#endif
+}
+
+inline void TaskWorkerPool::runWorker(const QSharedPointer<SharedState>& pState, int workerIndex) {
+    t_pCurrentPool = pState.data();
+    t_workerIndex = workerIndex;
+
+    std::function<void()> job;
+    while (!pState->m_shutdown.load()) {
+        if (pState->popLocal(workerIndex, job) || pState->steal(workerIndex, job)) {
+            job();
+            job = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(pState->m_sleepMutex);
+        pState->m_sleepingWorkers.fetch_add(1);
+        const auto hasWork = [&pState]() {
+            return pState->m_shutdown.load() || pState->m_pendingJobs.load() > 0;
+        };
+        bool woken = true;
+        if (pState->m_idleTimeoutMs < 0) {
+            pState->m_wakeCondition.wait(lock, hasWork);
+        } else {
+            woken = pState->m_wakeCondition.wait_for(lock, std::chrono::milliseconds(pState->m_idleTimeoutMs), hasWork);
+        }
+        pState->m_sleepingWorkers.fetch_sub(1);
+        lock.unlock();
+        if (!woken) {
+            std::lock_guard<std::mutex> growLock(pState->m_growMutex);
+            if (retireWorker(*pState, workerIndex)) {
+                break;
+            }
+        }
+    }
+
+    t_pCurrentPool = nullptr;
+    t_workerIndex = -1;
+}
+
+// Core Implementation
+inline Core::Core(QObject* parent)
+    : QObject(parent)
+    , m_completionQueue([this]() {
+        QMetaObject::invokeMethod(this, [this]() { scheduleFinishedTasksFlush(); }, Qt::QueuedConnection);
+    })
+    , m_submissionQueue([this]() {
+        QMetaObject::invokeMethod(this, [this]() { drainSubmissions(); }, Qt::QueuedConnection);
+    }) {
+    qRegisterMetaType<Core::TaskResult>("Core::TaskResult");
+    qRegisterMetaType<QVector<Core::TaskResult>>("QVector<Core::TaskResult>");
+}
+
+inline Core::~Core() {
+    if (m_pOwnerLink) {
+        std::lock_guard<std::mutex> lock(m_pOwnerLink->m_mutex);
+        m_pOwnerLink->m_pCore = nullptr;
+    }
+
+    if (m_pSchedulerThread) {
+        if (QThread::currentThread() == m_pSchedulerThread) {
+            // Deleted on its own scheduler thread (e.g. deleteLater): the thread cannot be joined from here.
+            shutdownForDestruction();
+            connect(m_pSchedulerThread, &QThread::finished, m_pSchedulerThread, &QObject::deleteLater);
+            m_pSchedulerThread->quit();
+            return;
+        }
+        // Shut down where the Core lives, then hand it back so QObject teardown happens on this thread.
+        QThread* pDeletingThread = QThread::currentThread();
+        QMetaObject::invokeMethod(this, [this, pDeletingThread]() {
+            shutdownForDestruction();
+            moveToThread(pDeletingThread);
+        }, Qt::BlockingQueuedConnection);
+        m_pSchedulerThread->quit();
+        m_pSchedulerThread->wait();
+        delete m_pSchedulerThread;
+        return;
+    }
+
+    // Best-effort synchronous shutdown to avoid destroying QObject children while worker threads are still running.
+    if (QThread::currentThread() != thread()) {
+        qWarning() << "Core::~Core - called from non-owner thread. owner =" << thread()
+                   << ", current =" << QThread::currentThread()
+                   << ". Forcing stop flags only.";
+        for (const auto& pTask : std::as_const(m_activeTasks)) {
+            pTask->m_stopFlag.store(true);
+        }
+        return;
+    }
+
+    shutdownForDestruction();
+}
+
+inline void Core::shutdownForDestruction() {
+    if (m_shutdownState == ShutdownState::Running) {
+        // The second half of the budget is only needed when stubborn tasks may be force-terminated.
+        shutdown(QDeadlineTimer(m_allowForceTermination ? 2 * qint64(m_shutdownTimeout) : qint64(m_shutdownTimeout)));
+    } else if (m_shutdownState == ShutdownState::ShuttingDown) {
+        // An earlier shutdown() may have no or a later deadline; the destructor must still return.
+        const QDeadlineTimer destructionDeadline(m_shutdownTimeout);
+        if (destructionDeadline.deadlineNSecs() < m_shutdownDeadline.deadlineNSecs()) {
+            m_shutdownDeadline = destructionDeadline;
+            scheduleDeadline(DeadlineKind::ShutdownDeadline, -1, m_shutdownDeadline);
+        }
+    }
+
+    // Tasks added after shutdown() wait in the queues forever; report them like the ones shutdown() dropped.
+    const auto queuedTasks = takeQueuedTasks();
+    for (const auto& pQueuedTask : queuedTasks) {
+        reportDroppedTask(pQueuedTask);
+    }
+
+    // Sleeps in the event dispatcher until thread exits or the shutdown deadline finish the shutdown.
+    if (QAbstractEventDispatcher::instance(thread()) != nullptr) {
+        while (m_shutdownState == ShutdownState::ShuttingDown) {
+            QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+        }
+    } else {
+        waitForShutdownWithoutDispatcher();
+    }
+
+    // Tasks released from their dependencies while the destructor waited.
+    const auto lateQueuedTasks = takeQueuedTasks();
+    for (const auto& pQueuedTask : lateQueuedTasks) {
+        reportDroppedTask(pQueuedTask);
+    }
+
+    if (!m_activeTasks.isEmpty()) {
+        qWarning() << "Core::~Core - active tasks still present after shutdown timeout:" << m_activeTasks.size();
+    }
+}
+
+// Neither queued completions nor QTimer deadlines are delivered without a dispatcher. Task ends wake this
+// loop through m_taskExitSignal; it delivers the posted events and runs the due deadlines itself.
+inline void Core::waitForShutdownWithoutDispatcher() {
+    ++m_taskExitSignal.m_waiters;
+    while (m_shutdownState == ShutdownState::ShuttingDown) {
+        quint64 seenExits;
+        {
+            std::lock_guard<std::mutex> lock(m_taskExitSignal.m_mutex);
+            seenExits = m_taskExitSignal.m_exits;
+        }
+        QCoreApplication::sendPostedEvents(this, 0);
+#ifndef Q_OS_WIN
+        if (m_pThreadExitNotifier) {
+            onTaskThreadsExited();
+        }
+#endif
+        processDeadlines();
+        if (m_shutdownState != ShutdownState::ShuttingDown) {
+            break;
+        }
+
+        // The shutdown deadline is always pending here, so the wait is bounded.
+        const qint64 waitMs = m_deadlines.empty() ? m_shutdownTimeout : std::max<qint64>(0, m_deadlines.top().m_dueMs - m_deadlineClock.elapsed());
+        std::unique_lock<std::mutex> lock(m_taskExitSignal.m_mutex);
+        m_taskExitSignal.m_condition.wait_for(lock, std::chrono::milliseconds(waitMs), [this, seenExits]() {
+            return m_taskExitSignal.m_exits != seenExits;
+        });
+    }
+    --m_taskExitSignal.m_waiters;
+}
+
+inline bool Core::ensureCalledFromOwnerThread(const char* method) const {
+    if (QThread::currentThread() == thread()) {
+        return true;
+    }
+    qWarning() << "Core::" << method
+               << "- called from non-owner thread. owner =" << thread()
+               << ", current =" << QThread::currentThread();
+    return false;
+}
+
+template <typename R, typename... Args>
+void Core::registerTask(TaskType taskType, std::function<R(Args...)> taskFunction, TaskGroup taskGroup, TaskStopTimeout taskStopTimeout) {
+    if (!ensureCalledFromOwnerThread("registerTask")) {
+        throw std::logic_error("Core::registerTask must be called from the owner thread");
+    }
+
+    // Parameters are stored decayed, which is also how addTask matches the arguments it is given.
+    std::function<QVariant(std::decay_t<Args>...)> f;
+
+    if constexpr (std::is_void_v<R>) {
+        f = [taskFunction](std::decay_t<Args>... args) -> QVariant {
+            taskFunction(std::forward<Args>(args)...);
+            return QVariant();
+        };
+    } else if constexpr (std::is_convertible_v<R, QVariant>) {
+        f = [taskFunction](std::decay_t<Args>... args) -> QVariant {
+            return taskFunction(std::forward<Args>(args)...);
+        };
+    } else if constexpr (QMetaTypeId<R>::Defined) {
+        f = [taskFunction](std::decay_t<Args>... args) -> QVariant {
+            return QVariant::fromValue(taskFunction(std::forward<Args>(args)...));
+        };
+    } else {
+        qWarning() << "Core::registerTask - Not convertible return type for task type:" << taskType;
+        throw std::logic_error("Not convertible return type");
+    }
+
+    auto typedFunction = TypedTaskFunctionPtr<R, std::decay_t<Args>...>::create([taskFunction](std::decay_t<Args>... args) -> R {
+        return taskFunction(std::forward<Args>(args)...);
+    });
+
+    insertToTaskHash(taskType, std::move(f), taskGroup, taskStopTimeout, std::move(typedFunction));
+}
+
+template <typename R, typename... Args>
+void Core::registerTask(TaskType taskType, R (*taskFunction)(Args...), TaskGroup taskGroup, TaskStopTimeout taskStopTimeout) {
+    // Use deduction guide for std::function
+    registerTask(taskType, std::function(taskFunction), taskGroup, taskStopTimeout);
+}
+
+template <typename Class, typename R, typename... Args>
+void Core::registerTask(TaskType taskType, R (Class::*taskMethod)(Args...), Class* taskObj, TaskGroup taskGroup, TaskStopTimeout taskStopTimeout) {
+    if (taskObj == nullptr) {
+        qWarning() << "Core::registerTask - task object is null for task type:" << taskType;
+        throw std::logic_error("Task object is null");
+    }
+
+    // Direct call to bind_placeholders and registerTask with explicit std::function signature
+    auto boundFunc = bind_placeholders(taskMethod, taskObj, std::make_index_sequence<sizeof...(Args)>());
+    // Use deduction guide for std::function
+    registerTask(taskType, static_cast<std::function<R(Args...)>>(std::move(boundFunc)), taskGroup, taskStopTimeout);
+}
+
+template <typename Class, typename R, typename... Args>
+void Core::registerTask(TaskType taskType, R (Class::*taskMethod)(Args...) const, Class* taskObj, TaskGroup taskGroup, TaskStopTimeout taskStopTimeout) {
+    if (taskObj == nullptr) {
+        qWarning() << "Core::registerTask - task object is null for task type:" << taskType;
+        throw std::logic_error("Task object is null");
+    }
+
+    auto boundFunc = bind_placeholders(taskMethod, taskObj, std::make_index_sequence<sizeof...(Args)>());
+    // Use deduction guide for std::function
+    registerTask(taskType, static_cast<std::function<R(Args...)>>(std::move(boundFunc)), taskGroup, taskStopTimeout);
+}
+
+// Generic overload (works for lambdas, functors)
+template <typename F>
+void Core::registerTask(TaskType taskType, F&& taskFunction, TaskGroup taskGroup, TaskStopTimeout taskStopTimeout) {
+    // Try to convert to std::function, relying on template argument deduction
+    // This works if F has an operator() with a unique signature
+    registerTask(taskType, std::function(std::forward<F>(taskFunction)), taskGroup, taskStopTimeout);
+}
+
+template <typename... Definitions>
+void Core::registerStaticTasks() {
+    static_assert((core_detail::isStaticTask<Definitions> && ...), "Core::registerStaticTasks - expects StaticTask definitions");
+    static_assert(core_detail::hasUniqueStaticTaskTypes<Definitions...>(), "Core::registerStaticTasks - duplicate task type");
+    static_assert((core_detail::StaticTaskSignatureOf<Definitions>::hasVariantResult && ...),
+                  "Core::registerStaticTasks - return type is not convertible to QVariant");
+
+    if (!ensureCalledFromOwnerThread("registerStaticTasks")) {
+        throw std::logic_error("Core::registerStaticTasks must be called from the owner thread");
+    }
+    // All or nothing: clashes with runtime registrations are found before anything is inserted.
+    const std::array<TaskType, sizeof...(Definitions)> taskTypes{Definitions::type...};
+    for (TaskType taskType : taskTypes) {
+        if (m_taskHash.contains(taskType)) {
+            qWarning() << "Core::registerStaticTasks - Task type is already registered:" << taskType;
+            throw std::logic_error("Task type is already registered");
+        }
+    }
+    ((registerTask(Definitions::type, Definitions::function, Definitions::group, Definitions::stopTimeout),
+      m_taskHash[Definitions::type].m_pStaticDefinition = &Definitions::registrationTag), ...);
+}
+
+inline bool Core::unregisterTask(TaskType taskType) {
+    if (!ensureCalledFromOwnerThread("unregisterTask")) {
+        return false;
+    }
+
+    if (m_activeTasksByType.contains(taskType)) {
+        qWarning() << "Core::unregisterTask - Cannot unregister active task type:" << taskType;
+        return false;
+    }
+    if (m_queuedCountByType.contains(taskType) || m_waitingCountByType.contains(taskType)) {
+        qWarning() << "Core::unregisterTask - Cannot unregister queued task type:" << taskType;
+        return false;
+    }
+    return m_taskHash.remove(taskType) > 0;
+}
+
+inline void Core::setGroupConcurrency(TaskGroup group, int maxActiveTasks) {
+    if (!ensureCalledFromOwnerThread("setGroupConcurrency")) {
+        return;
+    }
+
+    if (maxActiveTasks < 0) {
+        qWarning() << "Core::setGroupConcurrency - Negative limit for group:" << group
+                   << ". Using default:" << kDefaultGroupConcurrency;
+        maxActiveTasks = kDefaultGroupConcurrency;
+    }
+
+    if (maxActiveTasks == kDefaultGroupConcurrency) {
+        m_groupConcurrency.remove(group);
+    } else {
+        m_groupConcurrency.insert(group, maxActiveTasks);
+    }
+
+    // A raised limit may let queued tasks of the group start right away.
+    startQueuedTask(group);
+}
+
+inline int Core::groupConcurrency(TaskGroup group) const {
+    if (!ensureCalledFromOwnerThread("groupConcurrency")) {
+        return kDefaultGroupConcurrency;
+    }
+    return m_groupConcurrency.value(group, kDefaultGroupConcurrency);
+}
+
+inline bool Core::setGroupRateLimit(TaskGroup group, double tasksPerSecond, int burst) {
+    if (!ensureCalledFromOwnerThread("setGroupRateLimit")) {
+        return false;
+    }
+    if (!(tasksPerSecond >= 0.0) || burst < 1) {
+        qWarning() << "Core::setGroupRateLimit - Invalid limit for group:" << group
+                   << "tasksPerSecond:" << tasksPerSecond << "burst:" << burst;
+        return false;
+    }
+
+    if (tasksPerSecond == kUnlimitedGroupRate) {
+        m_groupRateLimits.remove(group);
+    } else {
+        // A new bucket starts full; a changed one keeps the tokens it has, up to the new burst.
+        auto limitIt = m_groupRateLimits.find(group);
+        if (limitIt == m_groupRateLimits.end()) {
+            limitIt = m_groupRateLimits.insert(group, GroupRateLimit());
+            limitIt.value().m_tokens = burst;
+            limitIt.value().m_refilledUs = core_detail::steadyMicros();
+        }
+        limitIt.value().m_tasksPerSecond = tasksPerSecond;
+        limitIt.value().m_burst = burst;
+        limitIt.value().m_tokens = std::min<double>(limitIt.value().m_tokens, burst);
+    }
+
+    startQueuedTask(group);
+    return true;
+}
+
+inline double Core::groupRateLimit(TaskGroup group) const {
+    if (!ensureCalledFromOwnerThread("groupRateLimit")) {
+        return kUnlimitedGroupRate;
+    }
+    auto limitIt = m_groupRateLimits.constFind(group);
+    return (limitIt != m_groupRateLimits.cend()) ? limitIt.value().m_tasksPerSecond : kUnlimitedGroupRate;
+}
+
+inline int Core::groupRateBurst(TaskGroup group) const {
+    if (!ensureCalledFromOwnerThread("groupRateBurst")) {
+        return 1;
+    }
+    auto limitIt = m_groupRateLimits.constFind(group);
+    return (limitIt != m_groupRateLimits.cend()) ? limitIt.value().m_burst : 1;
+}
+
+inline bool Core::setGroupQueueSpill(TaskGroup group, int maxInMemoryTasks, const QString& filePath) {
+    if (!ensureCalledFromOwnerThread("setGroupQueueSpill")) {
+        return false;
+    }
+
+    if (auto spillIt = m_groupSpills.find(group); spillIt != m_groupSpills.end()) {
+        if (maxInMemoryTasks > 0 && spillIt.value().m_pFile->fileName() == filePath) {
+            spillIt.value().m_maxInMemoryTasks = maxInMemoryTasks;
+            refillSpilledTasks(group);
+            return true;
+        }
+        // Switching files or disabling the spill first reads the current file back, so nothing is lost.
+        refillSpilledTasks(group, true);
+        m_groupSpills.remove(group);
+    }
+    if (maxInMemoryTasks <= 0) {
+        return true;
+    }
+
+    GroupSpill spill;
+    spill.m_maxInMemoryTasks = maxInMemoryTasks;
+    if (!openGroupSpill(group, spill, filePath)) {
+        return false;
+    }
+    const bool resumed = spill.m_pendingRecords > 0;
+    m_groupSpills.insert(group, std::move(spill));
+    // Tasks left by an earlier process join the queue as if they had just been added.
+    if (resumed) {
+        refillSpilledTasks(group);
+        startQueuedTask(group);
+    }
+    return true;
+}
+
+inline qint64 Core::spilledTaskCount(TaskGroup group) const {
+    if (!ensureCalledFromOwnerThread("spilledTaskCount")) {
+        return 0;
+    }
+    auto spillIt = m_groupSpills.constFind(group);
+    return (spillIt != m_groupSpills.cend()) ? spillIt.value().m_pendingRecords : 0;
+}
+
+inline bool Core::setGroupThreadPolicy(TaskGroup group, const TaskThreadPolicy& policy) {
+    if (!ensureCalledFromOwnerThread("setGroupThreadPolicy")) {
+        return false;
+    }
+
+    // Replacing a dedicated pool would drop the jobs of its running tasks.
+    if (m_activeTasksByGroup.contains(group)) {
+        qWarning() << "Core::setGroupThreadPolicy - Cannot change the policy of a group with active tasks:" << group;
+        return false;
+    }
+    if (policy.dedicatedWorkers < 0) {
+        qWarning() << "Core::setGroupThreadPolicy - Negative worker count for group:" << group;
+        return false;
+    }
+
+    auto pResolved = QSharedPointer<TaskThreadPolicy>::create(policy);
+    if (policy.numaNode >= 0) {
+        const QVector<int> nodeCpus = core_detail::numaNodeCpus(policy.numaNode);
+        QVector<int> cpus;
+        for (int cpu : nodeCpus) {
+            if (policy.cpuAffinity.isEmpty() || policy.cpuAffinity.contains(cpu)) {
+                cpus.append(cpu);
+            }
+        }
+        if (cpus.isEmpty()) {
+            qWarning() << "Core::setGroupThreadPolicy - No usable CPUs on NUMA node:" << policy.numaNode
+                       << "for group:" << group;
+            return false;
+        }
+        pResolved->cpuAffinity = cpus;
+    }
+
+    m_groupWorkerPools.remove(group);
+    if (policy.isDefault()) {
+        m_groupThreadPolicies.remove(group);
+        return true;
+    }
+    m_groupThreadPolicies.insert(group, pResolved);
+
+    if (m_pWorkerPool && pResolved->dedicatedWorkers > 0) {
+        auto pGroupPool = QSharedPointer<TaskWorkerPool>::create(pResolved->dedicatedWorkers, pResolved);
+        if (pGroupPool->workerCount() == 0) {
+            qWarning() << "Core::setGroupThreadPolicy - Failed to create any worker for group:" << group
+                       << ". The group uses the shared pool.";
+        } else {
+            m_groupWorkerPools.insert(group, pGroupPool);
+        }
+    }
+    return true;
+}
+
+inline TaskThreadPolicy Core::groupThreadPolicy(TaskGroup group) const {
+    if (!ensureCalledFromOwnerThread("groupThreadPolicy")) {
+        return {};
+    }
+    const auto pPolicy = m_groupThreadPolicies.value(group);
+    return pPolicy ? *pPolicy : TaskThreadPolicy();
+}
+
+inline bool Core::setTaskArgsCapture(TaskType taskType, ArgsCapture capture) {
+    if (!ensureCalledFromOwnerThread("setTaskArgsCapture")) {
+        return false;
+    }
+
+    auto taskInfoIt = m_taskHash.find(taskType);
+    if (taskInfoIt == m_taskHash.end()) {
+        qWarning() << "Core::setTaskArgsCapture - Task not registered for type:" << taskType;
+        return false;
+    }
+    // Applies to tasks added from now on; already queued tasks keep their argsList.
+    taskInfoIt.value().m_argsCapture = capture;
+    return true;
+}
+
+inline Core::ArgsCapture Core::taskArgsCapture(TaskType taskType) const {
+    if (!ensureCalledFromOwnerThread("taskArgsCapture")) {
+        return ArgsCapture::Eager;
+    }
+
+    auto taskInfoIt = m_taskHash.constFind(taskType);
+    return (taskInfoIt != m_taskHash.cend()) ? taskInfoIt.value().m_argsCapture : ArgsCapture::Eager;
+}
+
+inline bool Core::setTaskResultDelivery(TaskType taskType, ResultDelivery delivery) {
+    if (!ensureCalledFromOwnerThread("setTaskResultDelivery")) {
+        return false;
+    }
+
+    auto taskInfoIt = m_taskHash.find(taskType);
+    if (taskInfoIt == m_taskHash.end()) {
+        qWarning() << "Core::setTaskResultDelivery - Task not registered for type:" << taskType;
+        return false;
+    }
+    // Applies to tasks started from now on.
+    taskInfoIt.value().m_resultDelivery = delivery;
+    return true;
+}
+
+inline Core::ResultDelivery Core::taskResultDelivery(TaskType taskType) const {
+    if (!ensureCalledFromOwnerThread("taskResultDelivery")) {
+        return ResultDelivery::PerTask;
+    }
+
+    auto taskInfoIt = m_taskHash.constFind(taskType);
+    return (taskInfoIt != m_taskHash.cend()) ? taskInfoIt.value().m_resultDelivery : ResultDelivery::PerTask;
+}
+
+inline void Core::setResultFlushInterval(int intervalMs) {
+    if (!ensureCalledFromOwnerThread("setResultFlushInterval")) {
+        return;
+    }
+
+    if (intervalMs < 0) {
+        qWarning() << "Core::setResultFlushInterval - Negative interval:" << intervalMs << ". Using 0.";
+        intervalMs = 0;
+    }
+    m_resultFlushInterval = intervalMs;
+}
+
+inline int Core::resultFlushInterval() const {
+    if (!ensureCalledFromOwnerThread("resultFlushInterval")) {
+        return 0;
+    }
+    return m_resultFlushInterval;
+}
+
+// Stops everything without blocking: queued tasks are dropped, active ones get a cooperative stop request.
+// If force termination is allowed, tasks still running halfway to the deadline are terminated.
+// shutdownFinished is emitted once the last task is gone or the deadline expires; no task starts afterwards.
+inline void Core::shutdown(QDeadlineTimer deadline) {
+    if (!ensureCalledFromOwnerThread("shutdown")) {
+        return;
+    }
+
+    if (m_shutdownState != ShutdownState::Running) {
+        qWarning() << "Core::shutdown - shutdown already requested";
+        return;
+    }
+
+    m_shutdownState = ShutdownState::ShuttingDown;
+    m_blockStartTask.store(true);
+    m_resumeStartsWhenIdle = false;
+
+    // Remove queued tasks first: they never started.
+    const auto queuedTasks = takeQueuedTasks();
+    for (const auto& pQueuedTask : queuedTasks) {
+        reportDroppedTask(pQueuedTask);
+    }
+
+    if (m_activeTasks.isEmpty()) {
+        finishShutdown();
+        return;
+    }
+
+    for (const auto& pTask : std::as_const(m_activeTasks)) {
+        pTask->m_stopFlag.store(true);
+        if (pTask->m_state == TaskState::Active) {
+            pTask->m_state = TaskState::StopRequested;
+            emit stopRequestedTask(pTask->m_id, pTask->m_type, pTask->m_argsList);
+        }
+    }
+
+    if (!deadline.isForever()) {
+        if (m_allowForceTermination) {
+            m_shutdownEscalation = QDeadlineTimer(std::max<qint64>(0, deadline.remainingTime()) / 2);
+            scheduleDeadline(DeadlineKind::ShutdownEscalation, -1, m_shutdownEscalation);
+        }
+        m_shutdownDeadline = deadline;
+        scheduleDeadline(DeadlineKind::ShutdownDeadline, -1, m_shutdownDeadline);
+    }
+}
+
+inline bool Core::isShuttingDown() const {
+    if (!ensureCalledFromOwnerThread("isShuttingDown")) {
+        return false;
+    }
+    return m_shutdownState != ShutdownState::Running;
+}
+
+inline void Core::setShutdownTimeout(int timeoutMs) {
+    if (!ensureCalledFromOwnerThread("setShutdownTimeout")) {
+        return;
+    }
+
+    if (timeoutMs < 0) {
+        qWarning() << "Core::setShutdownTimeout - Negative timeout:" << timeoutMs << ". Using default:" << kDefaultShutdownTimeout;
+        timeoutMs = kDefaultShutdownTimeout;
+    }
+    m_shutdownTimeout = timeoutMs;
+}
+
+inline int Core::shutdownTimeout() const {
+    if (!ensureCalledFromOwnerThread("shutdownTimeout")) {
+        return kDefaultShutdownTimeout;
+    }
+    return m_shutdownTimeout;
+}
+
+inline void Core::finishShutdown() {
+    if (m_shutdownState != ShutdownState::ShuttingDown) {
+        return;
+    }
+    m_shutdownState = ShutdownState::ShutDown;
+    emit shutdownFinished(m_activeTasks.isEmpty());
+}
+
+inline bool Core::setTaskPriority(TaskType taskType, TaskPriority priority) {
+    if (!ensureCalledFromOwnerThread("setTaskPriority")) {
+        return false;
+    }
+
+    auto taskInfoIt = m_taskHash.find(taskType);
+    if (taskInfoIt == m_taskHash.end()) {
+        qWarning() << "Core::setTaskPriority - Task not registered for type:" << taskType;
+        return false;
+    }
+    // Default for tasks of this type added from now on; addTaskWithPriority overrides it per task.
+    taskInfoIt.value().m_priority = priority;
+    return true;
+}
+
+inline TaskPriority Core::taskPriority(TaskType taskType) const {
+    if (!ensureCalledFromOwnerThread("taskPriority")) {
+        return kDefaultTaskPriority;
+    }
+
+    auto taskInfoIt = m_taskHash.constFind(taskType);
+    return (taskInfoIt != m_taskHash.cend()) ? taskInfoIt.value().m_priority : kDefaultTaskPriority;
+}
+
+inline bool Core::setTaskResultCaching(TaskType taskType, int maxEntries) {
+    if (!ensureCalledFromOwnerThread("setTaskResultCaching")) {
+        return false;
+    }
+
+    auto taskInfoIt = m_taskHash.find(taskType);
+    if (taskInfoIt == m_taskHash.end()) {
+        qWarning() << "Core::setTaskResultCaching - Task not registered for type:" << taskType;
+        return false;
+    }
+    if (maxEntries < 0) {
+        qWarning() << "Core::setTaskResultCaching - Negative size for task type:" << taskType << ". Disabling the cache.";
+        maxEntries = 0;
+    }
+
+    auto& pResultCache = taskInfoIt.value().m_pResultCache;
+    if (maxEntries == 0) {
+        pResultCache.reset(); // runs in flight still resolve their attached duplicates
+    } else if (pResultCache) {
+        pResultCache->m_results.setMaxCost(maxEntries);
+    } else {
+        pResultCache = QSharedPointer<ResultCache>::create(maxEntries);
+    }
+    return true;
+}
+
+inline int Core::taskResultCaching(TaskType taskType) const {
+    if (!ensureCalledFromOwnerThread("taskResultCaching")) {
+        return 0;
+    }
+
+    auto taskInfoIt = m_taskHash.constFind(taskType);
+    if (taskInfoIt == m_taskHash.cend() || !taskInfoIt.value().m_pResultCache) {
+        return 0;
+    }
+    return taskInfoIt.value().m_pResultCache->m_results.maxCost();
+}
+
+inline void Core::setMetricsEnabled(bool enabled) {
+    if (!ensureCalledFromOwnerThread("setMetricsEnabled")) {
+        return;
+    }
+
+    // Tasks admitted while metrics were off stay untimed for their whole life.
+    if (!enabled) {
+        m_pMetrics.reset();
+    } else if (!m_pMetrics) {
+        m_pMetrics = std::make_unique<MetricsSnapshot>();
+    }
+}
+
+inline bool Core::isMetricsEnabled() const {
+    if (!ensureCalledFromOwnerThread("isMetricsEnabled")) {
+        return false;
+    }
+    return m_pMetrics != nullptr;
+}
+
+// Counters and histograms are copied; queue depth and active counts are read from the live queues.
+inline Core::MetricsSnapshot Core::metricsSnapshot() const {
+    if (!ensureCalledFromOwnerThread("metricsSnapshot") || !m_pMetrics) {
+        return {};
+    }
+
+    MetricsSnapshot snapshot = *m_pMetrics;
+    snapshot.total.queued = m_queuedTaskCount;
+    snapshot.total.active = m_activeTasks.size();
+    for (auto it = m_queuedCountByType.cbegin(); it != m_queuedCountByType.cend(); ++it) {
+        snapshot.byType[it.key()].queued = it.value();
+    }
+    for (auto it = m_activeTasksByType.cbegin(); it != m_activeTasksByType.cend(); ++it) {
+        snapshot.byType[it.key()].active = it.value().size();
+    }
+    for (auto it = m_queuedTasksByGroup.cbegin(); it != m_queuedTasksByGroup.cend(); ++it) {
+        snapshot.byGroup[it.key()].queued = it.value().size();
+    }
+    for (auto it = m_groupSpills.cbegin(); it != m_groupSpills.cend(); ++it) {
+        snapshot.byGroup[it.key()].queued += static_cast<int>(it.value().m_pendingRecords);
+    }
+    for (auto it = m_activeTasksByGroup.cbegin(); it != m_activeTasksByGroup.cend(); ++it) {
+        snapshot.byGroup[it.key()].active = it.value().size();
+    }
+    return snapshot;
+}
+
+inline void Core::setTracingEnabled(bool enabled, int eventCapacity) {
+    if (!ensureCalledFromOwnerThread("setTracingEnabled")) {
+        return;
+    }
+
+    // Re-enabling starts a fresh trace.
+    m_pTracer = enabled ? QSharedPointer<core_detail::TaskTracer>::create(eventCapacity) : nullptr;
+}
+
+inline bool Core::isTracingEnabled() const {
+    if (!ensureCalledFromOwnerThread("isTracingEnabled")) {
+        return false;
+    }
+    return !m_pTracer.isNull();
+}
+
+inline QByteArray Core::chromeTraceJson() const {
+    if (!ensureCalledFromOwnerThread("chromeTraceJson")) {
+        return {};
+    }
+    if (!m_pTracer) {
+        qWarning() << "Core::chromeTraceJson - Tracing is not enabled";
+        return {};
+    }
+    return m_pTracer->toChromeTraceJson();
+}
+
+inline void Core::resetMetrics() {
+    if (!ensureCalledFromOwnerThread("resetMetrics")) {
+        return;
+    }
+    if (m_pMetrics) {
+        *m_pMetrics = MetricsSnapshot();
+    }
+}
+
+inline void Core::setPriorityAging(int aging) {
+    if (!ensureCalledFromOwnerThread("setPriorityAging")) {
+        return;
+    }
+
+    if (aging < 0) {
+        qWarning() << "Core::setPriorityAging - Negative aging:" << aging << ". Using default:" << kDefaultPriorityAging;
+        aging = kDefaultPriorityAging;
+    }
+    // Affects tasks enqueued from now on; 0 makes the queues plain FIFO.
+    m_priorityAging = aging;
+}
+
+inline int Core::priorityAging() const {
+    if (!ensureCalledFromOwnerThread("priorityAging")) {
+        return kDefaultPriorityAging;
+    }
+    return m_priorityAging;
+}
+
+template <typename... Args>
+void Core::addTask(TaskType taskType, Args&&... args) {
+    addTaskImpl(taskType, AddTaskOptions(), std::forward<Args>(args)...);
+}
+
+template <typename... Args>
+void Core::addTaskWithPriority(TaskType taskType, TaskPriority priority, Args&&... args) {
+    AddTaskOptions options;
+    options.m_priority = priority;
+    addTaskImpl(taskType, std::move(options), std::forward<Args>(args)...);
+}
+
+template <typename... Args>
+void Core::addTaskWithDeadline(TaskType taskType, QDeadlineTimer deadline, Args&&... args) {
+    AddTaskOptions options;
+    options.m_deadline = deadline;
+    addTaskImpl(taskType, std::move(options), std::forward<Args>(args)...);
+}
+
+template <typename... Args>
+void Core::addTaskWithToken(const TaskCancellationToken& token, TaskType taskType, Args&&... args) {
+    AddTaskOptions options;
+    options.m_pCancellation = token.m_pNode;
+    addTaskImpl(taskType, std::move(options), std::forward<Args>(args)...);
+}
+
+template <typename... Args>
+void Core::addTaskImpl(TaskType taskType, AddTaskOptions options, Args&&... args) {
+    if (!ensureCalledFromOwnerThread("addTask")) {
+        throw std::logic_error("Core::addTask must be called from the owner thread");
+    }
+
+    auto taskInfoIt = m_taskHash.constFind(taskType);
+    if (taskInfoIt == m_taskHash.cend()) {
+        qWarning() << "Core::addTask - Task not registered for type:" << taskType;
+        throw std::logic_error("Task not registered");
+    }
+
+    const auto& taskInfo = taskInfoIt.value();
+    // Pointer form of any_cast: checks the signature without copying the stored callable.
+    const auto* pTaskFunction = std::any_cast<TaskFunctionPtr<std::decay_t<Args>...>>(&taskInfo.m_function);
+    if (pTaskFunction == nullptr) {
+        qWarning() << "Core::addTask - Bad arguments or function signature mismatch for task type:" << taskType;
+        throw std::logic_error("Bad arguments or function signature mismatch");
+    }
+
+    QList<QVariant> argsList = captureArgs(taskInfo, taskType, args...);
+    // Arguments are moved (or copied once, for lvalues) into the task and moved again into the call.
+    admitBoundTask(taskInfo, taskType, std::move(options), std::move(argsList), static_cast<int>(sizeof...(Args)),
+                   [pFunction = *pTaskFunction, boundArgs = std::tuple<std::decay_t<Args>...>(std::forward<Args>(args)...)]() mutable {
+        return std::apply(*pFunction, std::move(boundArgs));
+    });
+}
+
+template <typename Definition, typename... Args>
+std::enable_if_t<core_detail::isStaticTask<Definition>> Core::addTask(Args&&... args) {
+    using Signature = core_detail::StaticTaskSignatureOf<Definition>;
+    using BoundArgs = typename Signature::BoundArgs;
+    static_assert(std::is_constructible_v<BoundArgs, Args&&...>,
+                  "Core::addTask - arguments do not match the parameters of the static task");
+
+    if (!ensureCalledFromOwnerThread("addTask")) {
+        throw std::logic_error("Core::addTask must be called from the owner thread");
+    }
+
+    // Only the per-type settings are looked up; dispatch is resolved at compile time.
+    auto taskInfoIt = m_taskHash.constFind(Definition::type);
+    if (taskInfoIt == m_taskHash.cend() || taskInfoIt.value().m_pStaticDefinition != &Definition::registrationTag) {
+        qWarning() << "Core::addTask - Static task not registered for type:" << Definition::type;
+        throw std::logic_error("Static task not registered");
+    }
+
+    const auto& taskInfo = taskInfoIt.value();
+    BoundArgs boundArgs(std::forward<Args>(args)...);
+    QList<QVariant> argsList = std::apply([this, &taskInfo](const auto&... boundValues) {
+        return captureArgs(taskInfo, Definition::type, boundValues...);
+    }, boundArgs);
+    admitBoundTask(taskInfo, Definition::type, AddTaskOptions(), std::move(argsList), static_cast<int>(std::tuple_size_v<BoundArgs>),
+                   [boundArgs = std::move(boundArgs)]() mutable {
+        return Signature::template call<Definition::function>(boundArgs);
+    });
+}
+
+template <typename F>
+void Core::admitBoundTask(const TaskInfo& taskInfo, TaskType taskType, AddTaskOptions options,
+                          QList<QVariant> argsList, int argCount, F&& function) {
+    QByteArray cacheKey;
+    if (taskInfo.m_pResultCache) {
+        cacheKey = resultCacheKey(argsList, argCount);
+    }
+    if (!cacheKey.isEmpty()) {
+        ResultCache& cache = *taskInfo.m_pResultCache;
+        const TaskId id = options.m_presetId ? *options.m_presetId : reserveTaskIds(1);
+        if (const QVariant* pCachedResult = cache.m_results.object(cacheKey)) {
+            deliverCachedResult(id, taskType, argsList, *pCachedResult, taskInfo.m_resultDelivery);
+            return;
+        }
+        if (auto inFlightIt = cache.m_inFlight.find(cacheKey); inFlightIt != cache.m_inFlight.end()) {
+            inFlightIt.value().append(id);
+            m_cacheDuplicates.insert(id, CacheDuplicate{taskInfo.m_pResultCache, cacheKey, taskType, taskInfo.m_group, std::move(argsList)});
+            return;
+        }
+        cache.m_inFlight.insert(cacheKey, {});
+        options.m_presetId = id;
+    }
+
+    auto pTask = createTask(std::forward<F>(function), options.m_presetId ? *options.m_presetId : reserveTaskIds(1),
+                            taskType, taskInfo.m_group, std::move(argsList));
+    pTask->m_priority = options.m_priority.value_or(taskInfo.m_priority);
+    pTask->m_deadline = options.m_deadline;
+    pTask->m_pCancellation = std::move(options.m_pCancellation);
+    if (!cacheKey.isEmpty()) {
+        pTask->m_pResultCache = taskInfo.m_pResultCache;
+        pTask->m_cacheKey = std::move(cacheKey);
+    }
+    admitTask(std::move(pTask));
+}
+
+template <typename... Args>
+TaskId Core::postTask(TaskType taskType, Args&&... args) {
+    return postTaskImpl(taskType, std::nullopt, std::forward<Args>(args)...);
+}
+
+template <typename... Args>
+TaskId Core::postTaskWithPriority(TaskType taskType, TaskPriority priority, Args&&... args) {
+    return postTaskImpl(taskType, priority, std::forward<Args>(args)...);
+}
+
+// Registrations may change on the owner thread, so the lookup waits for the drain.
+template <typename... Args>
+TaskId Core::postTaskImpl(TaskType taskType, std::optional<TaskPriority> priority, Args&&... args) {
+    const TaskId id = reserveTaskIds(1);
+    m_submissionQueue.push([this, taskType, priority, id, boundArgs = std::tuple<std::decay_t<Args>...>(std::forward<Args>(args)...)]() mutable {
+        std::apply([this, taskType, priority, id](auto&&... unpackedArgs) {
+            AddTaskOptions options;
+            options.m_priority = priority;
+            options.m_presetId = id;
+            addTaskImpl(taskType, std::move(options), std::move(unpackedArgs)...);
+        }, std::move(boundArgs));
+    });
+    return id;
+}
+
+template <typename R, typename... Args>
+TaskHandle<R> Core::addTaskWithHandle(TaskType taskType, Args&&... args) {
+    if (!ensureCalledFromOwnerThread("addTaskWithHandle")) {
+        throw std::logic_error("Core::addTaskWithHandle must be called from the owner thread");
+    }
+
+    auto pTask = createHandleTask<R>("Core::addTaskWithHandle -", taskType, std::forward<Args>(args)...);
+    auto pState = pTask->m_pHandleState.template staticCast<core_detail::TaskHandleState<R>>();
+    admitTask(std::move(pTask));
+    return TaskHandle<R>(std::move(pState));
+}
+
+template <typename R, typename... Args>
+TaskHandle<R> Core::addTaskAfter(const QVector<TaskDependency>& dependencies, TaskType taskType, Args&&... args) {
+    if (!ensureCalledFromOwnerThread("addTaskAfter")) {
+        throw std::logic_error("Core::addTaskAfter must be called from the owner thread");
+    }
+    for (const auto& dependency : dependencies) {
+        if (dependency.m_pState.isNull()) {
+            qWarning() << "Core::addTaskAfter - Invalid dependency handle for task type:" << taskType;
+            throw std::logic_error("Invalid dependency handle");
+        }
+    }
+
+    auto pTask = createHandleTask<R>("Core::addTaskAfter -", taskType, std::forward<Args>(args)...);
+    auto pState = pTask->m_pHandleState.template staticCast<core_detail::TaskHandleState<R>>();
+    if (dependencies.isEmpty()) {
+        admitTask(std::move(pTask));
+        return TaskHandle<R>(std::move(pState));
+    }
+
+    const TaskId id = pTask->m_id;
+    WaitingTask waitingTask{std::move(pTask), {}};
+    for (const auto& dependency : dependencies) {
+        waitingTask.m_dependencies.append(dependency.m_id);
+        m_dependentTasks[dependency.m_id].append(id);
+    }
+    countWaitingTask(*waitingTask.m_pTask, 1);
+    m_waitingTasks.insert(id, std::move(waitingTask));
+
+    if (!m_pOwnerLink) {
+        m_pOwnerLink = QSharedPointer<OwnerLink>::create();
+        m_pOwnerLink->m_pCore = this;
+    }
+
+    // Dependencies are counted down on the thread that completes them. The release itself goes through
+    // the lock-free submission queue, so a burst of completions costs one wake-up of the owner thread;
+    // it cannot start the task from here, because queues and group limits belong to the owner thread.
+    auto pPendingCount = QSharedPointer<std::atomic_int>::create(static_cast<int>(dependencies.size()));
+    for (const auto& dependency : dependencies) {
+        dependency.m_pState->onDone([pLink = m_pOwnerLink, pPendingCount, id](bool finished) {
+            if (finished && pPendingCount->fetch_sub(1) != 1) {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(pLink->m_mutex);
+            if (Core* pCore = pLink->m_pCore) {
+                pCore->m_submissionQueue.push([pCore, id, finished]() {
+                    if (finished) {
+                        pCore->releaseWaitingTask(id);
+                    } else {
+                        pCore->cancelWaitingTask(id);
+                    }
+                });
+            }
+        });
+    }
+
+    return TaskHandle<R>(std::move(pState));
+}
+
+template <typename In, typename Out, typename F>
+void Core::registerPipelineStage(TaskType taskType, F&& transform, TaskGroup taskGroup, TaskStopTimeout taskStopTimeout) {
+    static_assert(!(std::is_void_v<In> && std::is_void_v<Out>), "A pipeline stage needs an input or an output");
+    if (!ensureCalledFromOwnerThread("registerPipelineStage")) {
+        throw std::logic_error("Core::registerPipelineStage must be called from the owner thread");
+    }
+
+    // Each instance runs its own copy, so a stateful transform is never shared between threads.
+    using Transform = std::decay_t<F>;
+    if constexpr (std::is_void_v<In>) {
+        registerTask(taskType, std::function<void(TaskChannel<Out>, core_detail::ChannelWriterPtr)>(
+            [registeredTransform = Transform(std::forward<F>(transform))](TaskChannel<Out> output, core_detail::ChannelWriterPtr pWriter) {
+                Transform transform = registeredTransform;
+                while (!core_detail::isCurrentTaskStopRequested()) {
+                    std::optional<Out> item = transform();
+                    if (!item || !output.push(std::move(*item))) {
+                        break;
+                    }
+                }
+                pWriter->release();
+            }), taskGroup, taskStopTimeout);
+    } else if constexpr (std::is_void_v<Out>) {
+        registerTask(taskType, std::function<void(TaskChannel<In>)>(
+            [registeredTransform = Transform(std::forward<F>(transform))](TaskChannel<In> input) {
+                Transform transform = registeredTransform;
+                while (std::optional<In> item = input.pop()) {
+                    transform(std::move(*item));
+                }
+            }), taskGroup, taskStopTimeout);
+    } else {
+        registerTask(taskType, std::function<void(TaskChannel<In>, TaskChannel<Out>, core_detail::ChannelWriterPtr)>(
+            [registeredTransform = Transform(std::forward<F>(transform))](TaskChannel<In> input, TaskChannel<Out> output, core_detail::ChannelWriterPtr pWriter) {
+                Transform transform = registeredTransform;
+                while (std::optional<In> item = input.pop()) {
+                    if (!output.push(transform(std::move(*item)))) {
+                        break;
+                    }
+                }
+                pWriter->release();
+            }), taskGroup, taskStopTimeout);
+    }
+    // Channels are not QVariant-convertible; nothing useful to capture.
+    setTaskArgsCapture(taskType, ArgsCapture::Disabled);
+}
+
+template <typename In, typename Out>
+void Core::addPipelineStage(TaskType taskType, TaskChannel<In> input, TaskChannel<Out> output, int instances) {
+    if (!ensureCalledFromOwnerThread("addPipelineStage")) {
+        throw std::logic_error("Core::addPipelineStage must be called from the owner thread");
+    }
+
+    warnIfStageExceedsGroup("Core::addPipelineStage -", taskType, instances);
+    for (int i = 0; i < instances; ++i) {
+        // Writers are counted here, before any instance can finish and close the output early.
+        addTask(taskType, input, output, output.acquireWriter());
+    }
+}
+
+template <typename In>
+void Core::addPipelineSink(TaskType taskType, TaskChannel<In> input, int instances) {
+    if (!ensureCalledFromOwnerThread("addPipelineSink")) {
+        throw std::logic_error("Core::addPipelineSink must be called from the owner thread");
+    }
+
+    warnIfStageExceedsGroup("Core::addPipelineSink -", taskType, instances);
+    for (int i = 0; i < instances; ++i) {
+        addTask(taskType, input);
+    }
+}
+
+template <typename Out>
+void Core::addPipelineSource(TaskType taskType, TaskChannel<Out> output, int instances) {
+    if (!ensureCalledFromOwnerThread("addPipelineSource")) {
+        throw std::logic_error("Core::addPipelineSource must be called from the owner thread");
+    }
+
+    warnIfStageExceedsGroup("Core::addPipelineSource -", taskType, instances);
+    for (int i = 0; i < instances; ++i) {
+        addTask(taskType, output, output.acquireWriter());
+    }
+}
+
+template <typename R, typename Map, typename Reduce>
+void Core::registerMapReduce(TaskType taskType, Map&& map, Reduce&& reduce, R identity, qint64 grainSize, TaskGroup taskGroup, TaskStopTimeout taskStopTimeout) {
+    registerTask(taskType, std::function<R(qint64, qint64)>(
+        [map = std::function<R(qint64, qint64)>(std::forward<Map>(map)),
+         reduce = std::function<R(R, R)>(std::forward<Reduce>(reduce)),
+         identity = std::move(identity), grainSize](qint64 begin, qint64 end) -> R {
+            return core_detail::runChunked<R>(begin, end, grainSize, map, reduce, identity);
+        }), taskGroup, taskStopTimeout);
+}
+
+template <typename F>
+void Core::registerParallelFor(TaskType taskType, F&& body, qint64 grainSize, TaskGroup taskGroup, TaskStopTimeout taskStopTimeout) {
+    registerTask(taskType, std::function<void(qint64, qint64)>(
+        [map = std::function<std::monostate(qint64, qint64)>([body = std::decay_t<F>(std::forward<F>(body))](qint64 begin, qint64 end) {
+            body(begin, end);
+            return std::monostate();
+        }), grainSize](qint64 begin, qint64 end) {
+            core_detail::runChunked<std::monostate>(begin, end, grainSize, map, [](std::monostate, std::monostate) { return std::monostate(); }, std::monostate());
+        }), taskGroup, taskStopTimeout);
+}
+
+// The returned id is the one to pass to cancelTaskById; it stops every chunk.
+inline TaskId Core::addParallelTask(TaskType taskType, qint64 begin, qint64 end) {
+    if (!ensureCalledFromOwnerThread("addParallelTask")) {
+        throw std::logic_error("Core::addParallelTask must be called from the owner thread");
+    }
+    return addTasks(taskType, std::vector<std::tuple<qint64, qint64>>{ { begin, end } }).first;
+}
+
+inline bool Core::startSchedulerThread() {
+    if (!ensureCalledFromOwnerThread("startSchedulerThread")) {
+        return false;
+    }
+    if (m_pSchedulerThread) {
+        qWarning() << "Core::startSchedulerThread - Scheduler thread is already running";
+        return false;
+    }
+    if (parent() != nullptr) {
+        qWarning() << "Core::startSchedulerThread - A Core with a parent cannot move to another thread";
+        return false;
+    }
+    if (m_shutdownState != ShutdownState::Running) {
+        qWarning() << "Core::startSchedulerThread - Core is shutting down";
+        return false;
+    }
+
+    auto* pThread = new QThread();
+    pThread->setObjectName(QStringLiteral("CoreScheduler"));
+    pThread->start();
+    // Helpers and timers are children, so they move along; running tasks report to the new thread.
+    moveToThread(pThread);
+    m_pSchedulerThread = pThread;
+    return true;
+}
+
+// Set once from the thread that started it, before any other thread can observe the move.
+inline bool Core::hasSchedulerThread() const {
+    return m_pSchedulerThread != nullptr;
+}
+
+inline void Core::postCancelTaskById(TaskId id) {
+    m_submissionQueue.push([this, id]() {
+        if (auto pQueuedTask = takeQueuedTask(id); !pQueuedTask.isNull()) {
+            reportDroppedTask(pQueuedTask);
+            return;
+        }
+        cancelTaskById(id);
+    });
+}
+
+inline void Core::drainSubmissions() {
+    auto commands = m_submissionQueue.takeAll();
+    for (auto& command : commands) {
+        try {
+            command();
+        } catch (const std::exception& e) {
+            qWarning() << "Core::postTask - Posted task dropped:" << e.what();
+        }
+    }
+}
+
+// Stages block on their channels, so instances that do not fit into the group wait until the others end,
+// and in WorkerPool mode instances beyond the pool workers may never start at all.
+inline void Core::warnIfStageExceedsGroup(const char* warningPrefix, TaskType taskType, int instances) const {
+    auto taskInfoIt = m_taskHash.constFind(taskType);
+    if (taskInfoIt == m_taskHash.cend()) {
+        return; // addTask reports it
+    }
+    const TaskGroup group = taskInfoIt.value().m_group;
+    const int limit = m_groupConcurrency.value(group, kDefaultGroupConcurrency);
+    if (limit != kUnlimitedGroupConcurrency && instances > limit) {
+        qWarning() << warningPrefix << "Stage instances exceed the concurrency of group" << group
+                   << "for task type:" << taskType << ". Extra instances start only after others finish.";
+    }
+    // On a pool a stage pins its worker, and a queued instance behind the workers never gets one.
+    const TaskWorkerPool* pWorkerPool = m_pWorkerPool.get();
+    if (auto groupPoolIt = m_groupWorkerPools.constFind(group); groupPoolIt != m_groupWorkerPools.cend()) {
+        pWorkerPool = groupPoolIt.value().data();
+    }
+    if (pWorkerPool != nullptr && instances > pWorkerPool->maxWorkerCount()) {
+        qWarning() << warningPrefix << "Stage instances exceed the" << pWorkerPool->maxWorkerCount()
+                   << "workers of the pool for task type:" << taskType << ". The pipeline can deadlock.";
+    }
+}
+
+template <typename R, typename... Args>
+QSharedPointer<Core::Task> Core::createHandleTask(const char* warningPrefix, TaskType taskType, Args&&... args) {
+    auto taskInfoIt = m_taskHash.constFind(taskType);
+    if (taskInfoIt == m_taskHash.cend()) {
+        qWarning() << warningPrefix << "Task not registered for type:" << taskType;
+        throw std::logic_error("Task not registered");
+    }
+
+    const auto& taskInfo = taskInfoIt.value();
+    const auto* pTaskFunction = std::any_cast<TypedTaskFunctionPtr<R, std::decay_t<Args>...>>(&taskInfo.m_typedFunction);
+    if (pTaskFunction == nullptr) {
+        qWarning() << warningPrefix << "Bad arguments, result type or function signature mismatch for task type:" << taskType;
+        throw std::logic_error("Bad arguments or function signature mismatch");
+    }
+
+    QList<QVariant> argsList = captureArgs(taskInfo, taskType, args...);
+
+    // The result is handed to the handle on the task thread; finishedTask carries an empty result.
+    const TaskId id = reserveTaskIds(1);
+    auto pState = QSharedPointer<core_detail::TaskHandleState<R>>::create(id, this);
+    auto pTask = createTask([pFunction = *pTaskFunction, pState, boundArgs = std::tuple<std::decay_t<Args>...>(std::forward<Args>(args)...)]() mutable {
+        if constexpr (std::is_void_v<R>) {
+            std::apply(*pFunction, std::move(boundArgs));
+            pState->finish(std::monostate());
+        } else {
+            pState->finish(std::apply(*pFunction, std::move(boundArgs)));
+        }
+        return QVariant();
+    }, id, taskType, taskInfo.m_group, std::move(argsList));
+    pTask->m_priority = taskInfo.m_priority;
+    pTask->m_pHandleState = std::move(pState);
+    return pTask;
+}
+
+template <typename... Args>
+QList<QVariant> Core::captureArgs(const TaskInfo& taskInfo, TaskType taskType, const Args&... args) const {
+    QList<QVariant> argsList;
+    // The result cache is keyed on the captured arguments, so it needs them regardless of the capture mode.
+    // A spilled task is rebuilt from its arguments, so spilling groups need them as well.
+    if (taskInfo.m_pResultCache || isArgsCaptureNeeded(taskInfo.m_argsCapture) || isSpillCaptureNeeded(taskInfo.m_group)) {
+        if constexpr (all_convertible_to<QVariant>::check<std::decay_t<Args>...>()) {
+            argsList = { QVariant::fromValue(args)... };
+        } else {
+            Q_UNUSED(taskType);
+            qWarning() << "Core::addTask - Arguments are not convertible to QList<QVariant> for task type:" << taskType;
+        }
+    }
+    return argsList;
+}
+
+// Every way into the scheduler passes here: attaches the tracer and, while metrics are on, the
+// admission time the queue wait is measured from. admittedUs == 0 reads the clock.
+inline void Core::recordTaskAdmitted(Task& task, qint64 admittedUs, bool countAdded) {
+    task.m_pTracer = m_pTracer;
+    if (!m_pMetrics) {
+        return;
+    }
+    task.m_timed = true;
+    task.m_admittedUs = (admittedUs != 0) ? admittedUs : core_detail::steadyMicros();
+    if (countAdded) {
+        updateMetrics(task, [](TaskMetrics& metrics) { ++metrics.added; });
+    }
+}
+
+inline void Core::admitTask(QSharedPointer<Task> pTask) {
+    recordTaskAdmitted(*pTask, 0, true);
+    if (pTask->m_pCancellation && pTask->m_pCancellation->isCanceled()) {
+        reportDroppedTask(pTask);
+        return;
+    }
+    if (!pTask->m_deadline.isForever()) {
+        if (pTask->m_deadline.hasExpired()) {
+            reportExpiredTask(pTask);
+            return;
+        }
+        m_deadlineTasks.insert(pTask->m_id, pTask.toWeakRef());
+        scheduleTaskDeadline(*pTask);
+    }
+    if (!isGroupBusy(pTask->m_group) && !m_blockStartTask.load() && takeRateToken(pTask->m_group, false)) {
+        startTask(std::move(pTask));
+    } else {
+        enqueueTask(std::move(pTask));
+    }
+}
+
+template <typename Range>
+Core::TaskIdRange Core::addTasks(TaskType taskType, Range&& argsTuples) {
+    using ArgsTuple = std::remove_cv_t<std::remove_reference_t<decltype(*std::begin(argsTuples))>>;
+    return addTasksImpl(taskType, std::forward<Range>(argsTuples), static_cast<ArgsTuple*>(nullptr));
+}
+
+template <typename Range, typename... Args>
+Core::TaskIdRange Core::addTasksImpl(TaskType taskType, Range&& argsTuples, std::tuple<Args...>*) {
+    using BoundArgs = std::tuple<std::decay_t<Args>...>;
+
+    if (!ensureCalledFromOwnerThread("addTasks")) {
+        throw std::logic_error("Core::addTasks must be called from the owner thread");
+    }
+
+    // Registration, signature and capture policy are resolved once for the whole batch.
+    auto taskInfoIt = m_taskHash.constFind(taskType);
+    if (taskInfoIt == m_taskHash.cend()) {
+        qWarning() << "Core::addTasks - Task not registered for type:" << taskType;
+        throw std::logic_error("Task not registered");
+    }
+
+    const auto& taskInfo = taskInfoIt.value();
+    const auto* pTaskFunction = std::any_cast<TaskFunctionPtr<std::decay_t<Args>...>>(&taskInfo.m_function);
+    if (pTaskFunction == nullptr) {
+        qWarning() << "Core::addTasks - Bad arguments or function signature mismatch for task type:" << taskType;
+        throw std::logic_error("Bad arguments or function signature mismatch");
+    }
+
+    const TaskIdRange range{reserveTaskIds(static_cast<TaskId>(std::size(argsTuples))), static_cast<TaskId>(std::size(argsTuples))};
+    if (range.isEmpty()) {
+        return range;
+    }
+
+    bool captureArgs = isArgsCaptureNeeded(taskInfo.m_argsCapture) || isSpillCaptureNeeded(taskInfo.m_group);
+    if constexpr (!all_convertible_to<QVariant>::check<std::decay_t<Args>...>()) {
+        if (captureArgs) {
+            qWarning() << "Core::addTasks - Arguments are not convertible to QList<QVariant> for task type:" << taskType;
+            captureArgs = false;
+        }
+    }
+
+    const TaskGroup group = taskInfo.m_group;
+    QList<QSharedPointer<Task>> batch;
+    batch.reserve(static_cast<int>(range.count));
+    TaskId nextId = range.first;
+    for (auto& argsTuple : argsTuples) {
+        BoundArgs boundArgs = [&argsTuple]() -> BoundArgs {
+            if constexpr (std::is_lvalue_reference_v<Range>) {
+                return BoundArgs(argsTuple);
+            } else {
+                return BoundArgs(std::move(argsTuple));
+            }
+        }();
+
+        QList<QVariant> argsList;
+        if constexpr (all_convertible_to<QVariant>::check<std::decay_t<Args>...>()) {
+            if (captureArgs) {
+                argsList = std::apply([](const auto&... args) {
+                    return QList<QVariant>{ QVariant::fromValue(args)... };
+                }, boundArgs);
+            }
+        }
+
+        batch.append(createTask([pFunction = *pTaskFunction, boundArgs = std::move(boundArgs)]() mutable {
+            return std::apply(*pFunction, std::move(boundArgs));
+        }, nextId++, taskType, group, std::move(argsList)));
+        batch.last()->m_priority = taskInfo.m_priority;
+    }
+
+    // The whole batch joins the group queue before anything starts, so tasks added from
+    // startedTask handlers line up behind it; free slots are then filled from the head.
+    const qint64 admittedUs = m_pMetrics ? core_detail::steadyMicros() : 0;
+    for (auto& pTask : batch) {
+        recordTaskAdmitted(*pTask, admittedUs, true);
+        enqueueTask(std::move(pTask));
+    }
+    startQueuedTask(group);
+
+    return range;
+}
+
+[[nodiscard]] inline std::atomic_bool* Core::stopTaskFlag() {
+    return core_detail::g_currentStopFlag;
+}
+
+inline void Core::terminateTaskById(TaskId id) {
+    if (!ensureCalledFromOwnerThread("terminateTaskById")) {
+        return;
+    }
+
+    if (auto pTask = activeTaskById(id); !pTask.isNull()) {
+        if (!m_allowForceTermination) {
+            qWarning() << "Core::terminateTaskById - force termination is disabled. Requesting cooperative stop for task ID:" << id;
+            stopTaskById(id);
+            return;
+        }
+        terminateTask(std::move(pTask));
+    }
+}
+
+inline void Core::setAllowForceTermination(bool allow) {
+    if (!ensureCalledFromOwnerThread("setAllowForceTermination")) {
+        return;
+    }
+    m_allowForceTermination = allow;
+}
+
+inline bool Core::allowForceTermination() const {
+    if (!ensureCalledFromOwnerThread("allowForceTermination")) {
+        return false;
+    }
+    return m_allowForceTermination;
+}
+
+inline bool Core::setExecutionMode(ExecutionMode mode, int workerCount) {
+    if (!ensureCalledFromOwnerThread("setExecutionMode")) {
+        return false;
+    }
+
+    // Switching executors under running or queued tasks would split them between two ownership models.
+    if (!m_activeTasks.isEmpty() || m_queuedTaskCount > 0 || !m_waitingTasks.isEmpty()) {
+        qWarning() << "Core::setExecutionMode - Cannot change execution mode while tasks are active or queued";
+        return false;
+    }
+
+    if (mode == ExecutionMode::DedicatedThreads) {
+        m_pWorkerPool.reset();
+        m_groupWorkerPools.clear();
+        m_executionMode = mode;
+        return true;
+    }
+
+    if (workerCount <= 0) {
+        workerCount = std::max(1, QThread::idealThreadCount());
+    }
+    return installWorkerPool(std::make_unique<TaskWorkerPool>(workerCount), "setExecutionMode");
+}
+
+inline bool Core::setAdaptiveWorkerPool(int minWorkers, int maxWorkers, int idleTimeoutMs) {
+    if (!ensureCalledFromOwnerThread("setAdaptiveWorkerPool")) {
+        return false;
+    }
+    if (minWorkers < 1 || maxWorkers < minWorkers || idleTimeoutMs < 0) {
+        qWarning() << "Core::setAdaptiveWorkerPool - Invalid bounds. minWorkers:" << minWorkers
+                   << "maxWorkers:" << maxWorkers << "idleTimeoutMs:" << idleTimeoutMs;
+        return false;
+    }
+    if (!m_activeTasks.isEmpty() || m_queuedTaskCount > 0 || !m_waitingTasks.isEmpty()) {
+        qWarning() << "Core::setAdaptiveWorkerPool - Cannot change execution mode while tasks are active or queued";
+        return false;
+    }
+    return installWorkerPool(std::make_unique<TaskWorkerPool>(minWorkers, maxWorkers, idleTimeoutMs), "setAdaptiveWorkerPool");
+}
+
+inline bool Core::installWorkerPool(std::unique_ptr<TaskWorkerPool> pWorkerPool, const char* methodName) {
+    if (pWorkerPool->workerCount() == 0) {
+        qWarning() << "Core::" << methodName << "- Failed to create any pool worker. Keeping current mode.";
+        return false;
+    }
+    m_pWorkerPool = std::move(pWorkerPool);
+    m_executionMode = ExecutionMode::WorkerPool;
+    m_groupWorkerPools.clear();
+    for (auto policyIt = m_groupThreadPolicies.cbegin(); policyIt != m_groupThreadPolicies.cend(); ++policyIt) {
+        if (policyIt.value()->dedicatedWorkers > 0) {
+            m_groupWorkerPools.insert(policyIt.key(), QSharedPointer<TaskWorkerPool>::create(policyIt.value()->dedicatedWorkers, policyIt.value()));
+        }
+    }
+    return true;
+}
+
+inline Core::ExecutionMode Core::executionMode() const {
+    if (!ensureCalledFromOwnerThread("executionMode")) {
+        return ExecutionMode::DedicatedThreads;
+    }
+    return m_executionMode;
+}
+
+inline int Core::workerCount() const {
+    if (!ensureCalledFromOwnerThread("workerCount")) {
+        return 0;
+    }
+    return m_pWorkerPool ? m_pWorkerPool->workerCount() : 0;
+}
+
+inline void Core::cancelTaskById(TaskId id) {
+    if (!ensureCalledFromOwnerThread("cancelTaskById")) {
+        return;
+    }
+    stopTaskById(id);
+}
+
+inline void Core::cancelTaskByType(TaskType type) {
+    if (!ensureCalledFromOwnerThread("cancelTaskByType")) {
+        return;
+    }
+    stopTaskByType(type);
+}
+
+inline void Core::cancelTaskByGroup(TaskGroup group) {
+    if (!ensureCalledFromOwnerThread("cancelTaskByGroup")) {
+        return;
+    }
+    stopTaskByGroup(group);
+}
+
+inline void Core::cancelTasks() {
+    if (!ensureCalledFromOwnerThread("cancelTasks")) {
+        return;
+    }
+    stopTasks();
+}
+
+inline void Core::cancelAllTasks() {
+    if (!ensureCalledFromOwnerThread("cancelAllTasks")) {
+        return;
+    }
+    stopAllTasks();
+}
+
+inline void Core::cancelTasksByGroup(TaskGroup group, bool includeQueued) {
+    if (!ensureCalledFromOwnerThread("cancelTasksByGroup")) {
+        return;
+    }
+    stopTasksByGroup(group, includeQueued);
+}
+
+inline void Core::stopTaskById(TaskId id) {
+    if (!ensureCalledFromOwnerThread("stopTaskById")) {
+        return;
+    }
+
+    if (auto pTask = activeTaskById(id); !pTask.isNull()) {
+        stopTask(std::move(pTask));
+    } else if (dropCacheDuplicate(id)) {
+        return;
+    }
+
+    // Stopping a graph node also cancels everything downstream of it that has not started yet.
+    if (m_waitingTasks.contains(id)) {
+        cancelWaitingTask(id);
+    } else {
+        cancelDependentTasks(id);
+    }
+}
+
+inline void Core::stopTaskByType(TaskType type) {
+    if (!ensureCalledFromOwnerThread("stopTaskByType")) {
+        return;
+    }
+
+    if (auto pTask = activeTaskByType(type); !pTask.isNull()) {
+        stopTask(std::move(pTask));
+    }
+}
+
+inline void Core::stopTaskByGroup(TaskGroup group) {
+    if (!ensureCalledFromOwnerThread("stopTaskByGroup")) {
+        return;
+    }
+
+    stopTasksByGroup(group, false);
+}
+
+inline void Core::stopTasks() {
+    if (!ensureCalledFromOwnerThread("stopTasks")) {
+        return;
+    }
+
+    if (m_activeTasks.isEmpty()) {
+        return;
+    }
+
+    m_blockStartTask.store(true);
+
+    // Calculating the maximum stop timeout among active tasks
+    TaskStopTimeout maxTimeout = 0;
+    const auto activeTasks = m_activeTasks.values();
+    for (const auto& pTask : activeTasks) {
+        auto taskInfoIt = m_taskHash.constFind(pTask->m_type);
+        if (taskInfoIt != m_taskHash.cend()) {
+            maxTimeout = std::max(maxTimeout, taskInfoIt.value().m_stopTimeout);
+        } else {
+            maxTimeout = std::max(maxTimeout, static_cast<TaskStopTimeout>(kDefaultStopTimeout));
+            qWarning() << "Core::stopTasks - Missing registration for active task type:" << pTask->m_type;
+        }
+    }
+
+    // Requesting to stop all active tasks
+    for (const auto& pTask : activeTasks) {
+        stopTask(pTask);
+    }
+
+    // Queued tasks stay blocked for the whole stop window and then until the last active task is gone.
+    scheduleDeadline(DeadlineKind::ResumeStarts, -1, maxTimeout);
 }
 
-inline bool Core::ensureCalledFromOwnerThread(const char* method) const {
-    if (QThread::currentThread() == thread()) {
+inline void Core::stopAllTasks() {
+    if (!ensureCalledFromOwnerThread("stopAllTasks")) {
+        return;
+    }
+
+    // Remove queued tasks immediately (they never started, so no stop timeout needed).
+    dropCacheDuplicates(std::nullopt);
+    const auto queuedTasks = takeQueuedTasks();
+    for (const auto& pQueuedTask : queuedTasks) {
+        reportDroppedTask(pQueuedTask);
+    }
+    for (TaskGroup group : m_groupSpills.keys()) {
+        discardSpilledTasks(group);
+    }
+
+    // Then request stop for all currently active tasks.
+    stopTasks();
+}
+
+inline void Core::stopTasksByGroup(TaskGroup group, bool includeQueued) {
+    if (!ensureCalledFromOwnerThread("stopTasksByGroup")) {
+        return;
+    }
+
+    if (auto activeIt = m_activeTasksByGroup.constFind(group); activeIt != m_activeTasksByGroup.cend()) {
+        const auto activeInGroup = activeIt.value().values();
+        for (const auto& pTask : activeInGroup) {
+            stopTask(pTask);
+        }
+    }
+
+    if (!includeQueued) {
+        return;
+    }
+
+    dropCacheDuplicates(group);
+    const auto queuedInGroup = takeQueuedTasks(group);
+    for (const auto& pQueuedTask : queuedInGroup) {
+        reportDroppedTask(pQueuedTask);
+    }
+    discardSpilledTasks(group);
+}
+
+[[nodiscard]] inline bool Core::isTaskRegistered(TaskType type) {
+    if (!ensureCalledFromOwnerThread("isTaskRegistered")) {
+        return false;
+    }
+
+    return m_taskHash.contains(type);
+}
+
+inline TaskGroup Core::groupByTask(TaskType type, bool* ok) {
+    if (!ensureCalledFromOwnerThread("groupByTask")) {
+        if (ok) *ok = false;
+        return -1;
+    }
+
+    auto taskInfoIt = m_taskHash.constFind(type);
+    if (taskInfoIt != m_taskHash.cend()) {
+        if (ok) *ok = true;
+        return taskInfoIt.value().m_group;
+    } else {
+        if (ok) *ok = false;
+        return -1;
+    }
+}
+
+[[nodiscard]] inline bool Core::isIdle() {
+    if (!ensureCalledFromOwnerThread("isIdle")) {
+        return false;
+    }
+
+    return m_activeTasks.isEmpty();
+}
+
+[[nodiscard]] inline bool Core::isTaskAddedByType(TaskType type, bool* isActive) {
+    if (!ensureCalledFromOwnerThread("isTaskAddedByType")) {
+        if (isActive) *isActive = false;
+        return false;
+    }
+
+    if (m_activeTasksByType.contains(type)) {
+        if (isActive) *isActive = true;
+        return true;
+    }
+    if (isActive) *isActive = false;
+    return m_queuedCountByType.contains(type) || m_waitingCountByType.contains(type);
+}
+
+[[nodiscard]] inline bool Core::isTaskAddedByGroup(TaskGroup group, bool* isActive) {
+    if (!ensureCalledFromOwnerThread("isTaskAddedByGroup")) {
+        if (isActive) *isActive = false;
+        return false;
+    }
+
+    if (m_activeTasksByGroup.contains(group)) {
+        if (isActive) *isActive = true;
+        return true;
+    }
+    if (isActive) *isActive = false;
+    if (m_queuedTasksByGroup.contains(group) || m_waitingCountByGroup.contains(group)) {
+        return true;
+    }
+    auto spillIt = m_groupSpills.constFind(group);
+    return spillIt != m_groupSpills.cend() && spillIt.value().m_pendingRecords > 0;
+}
+
+// --- Internal method implementations (inline) ---
+
+inline QSharedPointer<Core::Task> Core::activeTaskById(TaskId id) {
+    return m_activeTasks.value(id);
+}
+
+inline QSharedPointer<Core::Task> Core::activeTaskByType(TaskType type) {
+    // The per-type map is ordered by id, so this is the earliest started task of the type.
+    auto it = m_activeTasksByType.constFind(type);
+    return (it != m_activeTasksByType.cend()) ? it.value().first() : QSharedPointer<Task>{};
+}
+
+inline QSharedPointer<Core::Task> Core::activeTaskByGroup(TaskGroup group) {
+    auto it = m_activeTasksByGroup.constFind(group);
+    return (it != m_activeTasksByGroup.cend()) ? it.value().first() : QSharedPointer<Task>{};
+}
+
+inline void Core::insertActiveTask(const QSharedPointer<Task>& pTask) {
+    m_activeTasks.insert(pTask->m_id, pTask);
+    m_activeTasksByType[pTask->m_type].insert(pTask->m_id, pTask);
+    m_activeTasksByGroup[pTask->m_group].insert(pTask->m_id, pTask);
+}
+
+inline void Core::removeActiveTask(const QSharedPointer<Task>& pTask) {
+    // Both the finished and the terminated path may reach here for the same task.
+    if (m_activeTasks.remove(pTask->m_id) == 0) {
+        return;
+    }
+    if (auto typeIt = m_activeTasksByType.find(pTask->m_type); typeIt != m_activeTasksByType.end()) {
+        typeIt.value().remove(pTask->m_id);
+        if (typeIt.value().isEmpty()) {
+            m_activeTasksByType.erase(typeIt);
+        }
+    }
+    if (auto groupIt = m_activeTasksByGroup.find(pTask->m_group); groupIt != m_activeTasksByGroup.end()) {
+        groupIt.value().remove(pTask->m_id);
+        if (groupIt.value().isEmpty()) {
+            m_activeTasksByGroup.erase(groupIt);
+        }
+    }
+
+    // Deferred so that the caller finishes its own bookkeeping before queued tasks start.
+    if (m_resumeStartsWhenIdle && m_activeTasks.isEmpty()) {
+        m_resumeStartsWhenIdle = false;
+        QMetaObject::invokeMethod(this, [this]() { resumeStarts(); }, Qt::QueuedConnection);
+    }
+    if (m_shutdownState == ShutdownState::ShuttingDown && m_activeTasks.isEmpty()) {
+        QMetaObject::invokeMethod(this, [this]() { finishShutdown(); }, Qt::QueuedConnection);
+    }
+}
+
+inline void Core::enqueueTask(QSharedPointer<Task> pTask) {
+    pTask->trace(core_detail::TraceEventKind::Queued);
+    if (!m_groupSpills.isEmpty() && spillTask(pTask)) {
+        return;
+    }
+    insertQueuedTask(std::move(pTask));
+}
+
+inline void Core::insertQueuedTask(QSharedPointer<Task> pTask) {
+    ++m_queuedCountByType[pTask->m_type];
+    ++m_queuedTaskCount;
+    pTask->m_queueRank = m_queueTick++ - static_cast<qint64>(pTask->m_priority) * m_priorityAging;
+    const QueueKey key{pTask->m_queueRank, pTask->m_priority, pTask->m_id};
+    m_queuedTasksByGroup[pTask->m_group].insert(key, std::move(pTask));
+}
+
+// Bookkeeping for a task that has just been taken out of its group queue.
+inline void Core::releaseQueuedTask(const QSharedPointer<Task>& pTask) {
+    if (auto typeIt = m_queuedCountByType.find(pTask->m_type); typeIt != m_queuedCountByType.end() && --typeIt.value() <= 0) {
+        m_queuedCountByType.erase(typeIt);
+    }
+    --m_queuedTaskCount;
+}
+
+// Returns the queued tasks of a group in start order.
+inline QList<QSharedPointer<Core::Task>> Core::takeQueuedTasks(TaskGroup group) {
+    const auto queuedTasks = m_queuedTasksByGroup.take(group).values();
+    for (const auto& pQueuedTask : std::as_const(queuedTasks)) {
+        releaseQueuedTask(pQueuedTask);
+    }
+    return queuedTasks;
+}
+
+// Linear in the number of queued tasks; only posted cancellations need it.
+inline QSharedPointer<Core::Task> Core::takeQueuedTask(TaskId id) {
+    for (auto groupIt = m_queuedTasksByGroup.begin(); groupIt != m_queuedTasksByGroup.end(); ++groupIt) {
+        GroupQueue& groupQueue = groupIt.value();
+        for (auto taskIt = groupQueue.begin(); taskIt != groupQueue.end(); ++taskIt) {
+            if (taskIt.value()->m_id != id) {
+                continue;
+            }
+            QSharedPointer<Task> pTask = taskIt.value();
+            groupQueue.erase(taskIt);
+            if (groupQueue.isEmpty()) {
+                m_queuedTasksByGroup.erase(groupIt);
+            }
+            releaseQueuedTask(pTask);
+            refillSpilledTasks(pTask->m_group);
+            return pTask;
+        }
+    }
+    return {};
+}
+
+// Logarithmic: the queue key is rebuilt from the rank stored by enqueueTask.
+inline bool Core::removeQueuedTask(const QSharedPointer<Task>& pTask) {
+    auto queueIt = m_queuedTasksByGroup.find(pTask->m_group);
+    if (queueIt == m_queuedTasksByGroup.end()
+        || queueIt.value().remove(QueueKey{pTask->m_queueRank, pTask->m_priority, pTask->m_id}) == 0) {
+        return false;
+    }
+    if (queueIt.value().isEmpty()) {
+        m_queuedTasksByGroup.erase(queueIt);
+    }
+    releaseQueuedTask(pTask);
+    refillSpilledTasks(pTask->m_group);
+    return true;
+}
+
+// Returns every queued task in submission order and leaves the queues empty.
+inline QList<QSharedPointer<Core::Task>> Core::takeQueuedTasks() {
+    QList<QSharedPointer<Task>> queuedTasks;
+    queuedTasks.reserve(m_queuedTaskCount);
+    for (const auto& groupQueue : std::as_const(m_queuedTasksByGroup)) {
+        queuedTasks.append(groupQueue.values());
+    }
+    std::sort(queuedTasks.begin(), queuedTasks.end(), [](const auto& pLeft, const auto& pRight) {
+        return pLeft->m_id < pRight->m_id;
+    });
+    m_queuedTasksByGroup.clear();
+    // The counts also hold the spilled records, which stay until discardSpilledTasks reads them.
+    for (const auto& pQueuedTask : std::as_const(queuedTasks)) {
+        releaseQueuedTask(pQueuedTask);
+    }
+
+    // Tasks still waiting for dependencies are dropped together with the queues.
+    for (const auto& waitingTask : std::as_const(m_waitingTasks)) {
+        queuedTasks.append(waitingTask.m_pTask);
+    }
+    m_waitingTasks.clear();
+    m_waitingCountByType.clear();
+    m_waitingCountByGroup.clear();
+    m_dependentTasks.clear();
+    return queuedTasks;
+}
+
+inline void Core::releaseWaitingTask(TaskId taskId) {
+    auto waitingIt = m_waitingTasks.find(taskId);
+    if (waitingIt == m_waitingTasks.end()) {
+        return; // canceled meanwhile
+    }
+    WaitingTask waitingTask = std::move(waitingIt.value());
+    m_waitingTasks.erase(waitingIt);
+    countWaitingTask(*waitingTask.m_pTask, -1);
+    detachFromDependencies(taskId, waitingTask.m_dependencies);
+    // shutdown() already dropped the queues; a late release must not refill them.
+    if (m_shutdownState != ShutdownState::Running) {
+        waitingTask.m_pTask->m_pHandleState->cancel();
+        reportDroppedTask(waitingTask.m_pTask);
+        cancelDependentTasks(taskId);
+        return;
+    }
+    admitTask(std::move(waitingTask.m_pTask));
+}
+
+// Tasks waiting for dependencies count as queued for the queries and for registration changes; the
+// counters keep those checks constant-time however large the dependency graph grows.
+inline void Core::countWaitingTask(const Task& task, int delta) {
+    if (auto typeIt = m_waitingCountByType.insert(task.m_type, m_waitingCountByType.value(task.m_type) + delta); typeIt.value() <= 0) {
+        m_waitingCountByType.erase(typeIt);
+    }
+    if (auto groupIt = m_waitingCountByGroup.insert(task.m_group, m_waitingCountByGroup.value(task.m_group) + delta); groupIt.value() <= 0) {
+        m_waitingCountByGroup.erase(groupIt);
+    }
+}
+
+inline void Core::cancelWaitingTask(TaskId taskId) {
+    auto waitingIt = m_waitingTasks.find(taskId);
+    if (waitingIt == m_waitingTasks.end()) {
+        return;
+    }
+    WaitingTask waitingTask = std::move(waitingIt.value());
+    m_waitingTasks.erase(waitingIt);
+    countWaitingTask(*waitingTask.m_pTask, -1);
+    detachFromDependencies(taskId, waitingTask.m_dependencies);
+
+    const auto& pTask = waitingTask.m_pTask;
+    pTask->m_state = TaskState::Terminated;
+    pTask->m_pHandleState->cancel();
+    emit terminatedTask(pTask->m_id, pTask->m_type, pTask->m_argsList);
+    cancelDependentTasks(taskId);
+}
+
+inline void Core::cancelDependentTasks(TaskId taskId) {
+    const auto dependentTasks = m_dependentTasks.take(taskId);
+    for (TaskId dependentId : dependentTasks) {
+        cancelWaitingTask(dependentId);
+    }
+}
+
+inline void Core::detachFromDependencies(TaskId taskId, const QVector<TaskId>& dependencies) {
+    for (TaskId dependencyId : dependencies) {
+        auto dependentIt = m_dependentTasks.find(dependencyId);
+        if (dependentIt == m_dependentTasks.end()) {
+            continue;
+        }
+        dependentIt.value().removeAll(taskId);
+        if (dependentIt.value().isEmpty()) {
+            m_dependentTasks.erase(dependentIt);
+        }
+    }
+}
+
+// Lazy capture pays for QVariant conversion only while someone listens to the task signals.
+inline bool Core::isArgsCaptureNeeded(ArgsCapture capture) const {
+    switch (capture) {
+    case ArgsCapture::Eager:
+        return true;
+    case ArgsCapture::Disabled:
+        return false;
+    case ArgsCapture::Lazy:
+        break;
+    }
+
+    static const QMetaMethod startedSignal = QMetaMethod::fromSignal(&Core::startedTask);
+    static const QMetaMethod finishedSignal = QMetaMethod::fromSignal(&Core::finishedTask);
+    static const QMetaMethod finishedBatchSignal = QMetaMethod::fromSignal(&Core::finishedTasks);
+    static const QMetaMethod terminatedSignal = QMetaMethod::fromSignal(&Core::terminatedTask);
+    static const QMetaMethod stopRequestedSignal = QMetaMethod::fromSignal(&Core::stopRequestedTask);
+    static const QMetaMethod stopTimedOutSignal = QMetaMethod::fromSignal(&Core::stopTimedOutTask);
+    static const QMetaMethod expiredSignal = QMetaMethod::fromSignal(&Core::expiredTask);
+    return isSignalConnected(startedSignal)
+        || isSignalConnected(finishedSignal)
+        || isSignalConnected(finishedBatchSignal)
+        || isSignalConnected(terminatedSignal)
+        || isSignalConnected(stopRequestedSignal)
+        || isSignalConnected(stopTimedOutSignal)
+        || isSignalConnected(expiredSignal);
+}
+
+// A group is busy once it runs as many tasks as its concurrency limit allows.
+inline bool Core::isGroupBusy(TaskGroup group) const {
+    auto activeIt = m_activeTasksByGroup.constFind(group);
+    if (activeIt == m_activeTasksByGroup.cend()) {
+        return false;
+    }
+    const int limit = m_groupConcurrency.value(group, kDefaultGroupConcurrency);
+    return limit != kUnlimitedGroupConcurrency && activeIt.value().size() >= limit;
+}
+
+// Refills the group's bucket for the time elapsed and takes a token if there is one. Otherwise a
+// RateRefill deadline wakes the group's queue when the next token is due. Unless bypassQueue is set,
+// tasks already held in the queue go first.
+inline bool Core::takeRateToken(TaskGroup group, bool bypassQueue) {
+    auto limitIt = m_groupRateLimits.find(group);
+    if (limitIt == m_groupRateLimits.end()) {
+        return true;
+    }
+    if (!bypassQueue && m_queuedTasksByGroup.contains(group)) {
+        return false;
+    }
+
+    GroupRateLimit& limit = limitIt.value();
+    const qint64 nowUs = core_detail::steadyMicros();
+    limit.m_tokens = std::min<double>(limit.m_burst, limit.m_tokens + (nowUs - limit.m_refilledUs) * limit.m_tasksPerSecond / 1e6);
+    limit.m_refilledUs = nowUs;
+    // Tolerates the rounding of the millisecond refill timer.
+    if (limit.m_tokens >= 1.0 - 1e-6) {
+        limit.m_tokens = std::max(0.0, limit.m_tokens - 1.0);
         return true;
     }
-    qWarning() << "Core::" << method
-               << "- called from non-owner thread. owner =" << thread()
-               << ", current =" << QThread::currentThread();
-    return false;
+    if (!limit.m_refillScheduled) {
+        limit.m_refillScheduled = true;
+        const double waitMs = std::ceil((1.0 - limit.m_tokens) * 1000.0 / limit.m_tasksPerSecond);
+        scheduleDeadline(DeadlineKind::RateRefill, group,
+                         static_cast<TaskStopTimeout>(std::clamp<double>(waitMs, 1.0, std::numeric_limits<TaskStopTimeout>::max())));
+    }
+    return false;
+}
+
+// For a task that was given a token but turned out expired or canceled before it started.
+inline void Core::returnRateToken(TaskGroup group) {
+    auto limitIt = m_groupRateLimits.find(group);
+    if (limitIt != m_groupRateLimits.end()) {
+        limitIt.value().m_tokens = std::min<double>(limitIt.value().m_burst, limitIt.value().m_tokens + 1.0);
+    }
+}
+
+inline void Core::terminateTask(QSharedPointer<Core::Task> pTask) {
+    // Set stop flag to request cooperative cancellation
+    pTask->m_stopFlag.store(true);
+
+    if (pTask->m_state == TaskState::Active) {
+        pTask->m_state = TaskState::StopRequested;
+        emit stopRequestedTask(pTask->m_id, pTask->m_type, pTask->m_argsList);
+    }
+
+    // Determine timeout from task's registered stop timeout (verification window).
+    TaskStopTimeout timeout = kDefaultStopTimeout;
+    auto taskInfoIt = m_taskHash.constFind(pTask->m_type);
+    if (taskInfoIt != m_taskHash.cend()) {
+        timeout = taskInfoIt.value().m_stopTimeout;
+    }
+
+    // Pool workers are shared between tasks, so they are never killed; only the cooperative stop applies.
+    if (pTask->m_pooled) {
+        pTask->m_state = TaskState::StopTimedOut;
+        qWarning() << QString("Task %1 runs on a pool worker; force termination is not supported").arg(QString::number(pTask->m_id));
+        reportStopTimedOut(pTask, timeout);
+        return;
+    }
+
+    // IMPORTANT: do not block the UI thread here.
+    // Request termination first, then confirm termination asynchronously.
+    bool terminationRequested = false;
+
+#ifdef Q_OS_WIN
+    if (pTask->m_threadHandle) {
+        if (WaitForSingleObject(pTask->m_threadHandle, 0) != WAIT_OBJECT_0) {
+            terminationRequested = (TerminateThread(pTask->m_threadHandle, 1) != 0);
+        } else {
+            // Thread already exited, but finishedTask might never be emitted (e.g. forceful exit path).
+            CloseHandle(pTask->m_threadHandle);
+            pTask->m_threadHandle = nullptr;
+            reportTerminated(pTask);
+            return;
+        }
+    } else {
+        return; // no valid handle
+    }
+#else
+    if (pTask->m_threadHandle != 0) {
+        if (!pTask->m_threadExited.load()) {
+            terminationRequested = (pthread_cancel(pTask->m_threadHandle) == 0);
+        } else {
+            // Thread already not alive, but finishedTask might never be emitted (e.g. pthread_exit/cancel path).
+            reportTerminated(pTask);
+            return;
+        }
+    } else {
+        return; // no valid handle
+    }
+#endif
+
+    if (!terminationRequested) {
+        pTask->m_state = TaskState::StopTimedOut;
+        qWarning() << QString("Task %1 terminate request was rejected by platform API").arg(QString::number(pTask->m_id));
+        reportStopTimedOut(pTask, timeout);
+        return;
+    }
+
+#ifdef Q_OS_WIN
+    // TerminateThread runs no code in the dying thread, so the handle itself reports the exit.
+    auto* pWatch = new ThreadExitWatch{this, pTask->m_id};
+    if (!RegisterWaitForSingleObject(&pTask->m_exitWaitHandle, pTask->m_threadHandle, &Core::threadHandleSignaled,
+                                     pWatch, INFINITE, WT_EXECUTEONLYONCE)) {
+        delete pWatch; // confirmation falls back to the check at the terminate deadline
+        pTask->m_exitWaitHandle = nullptr;
+    }
+#endif
+    // The thread exit notification confirms termination; the deadline only catches threads that never exit.
+    scheduleDeadline(DeadlineKind::TerminateTimeout, pTask->m_id, timeout);
 }
 
-template <typename R, typename... Args>
-void Core::registerTask(TaskType taskType, std::function<R(Args...)> taskFunction, TaskGroup taskGroup, TaskStopTimeout taskStopTimeout) {
-    if (!ensureCalledFromOwnerThread("registerTask")) {
-        throw std::logic_error("Core::registerTask must be called from the owner thread");
+inline void Core::stopTask(QSharedPointer<Core::Task> pTask) {
+    pTask->m_stopFlag.store(true);
+    if (pTask->m_state == TaskState::Active) {
+        pTask->m_state = TaskState::StopRequested;
+        pTask->trace(core_detail::TraceEventKind::StopRequested);
+        if (pTask->m_timed) {
+            pTask->m_stopRequestedUs = core_detail::steadyMicros();
+            updateMetrics(*pTask, [](TaskMetrics& metrics) { ++metrics.stopRequests; });
+        }
+        emit stopRequestedTask(pTask->m_id, pTask->m_type, pTask->m_argsList);
     }
 
-    std::function<QVariant(std::remove_reference_t<Args>...)> f;
-
-    if constexpr (std::is_void_v<R>) {
-        f = [taskFunction](std::remove_reference_t<Args>... args) -> QVariant {
-            taskFunction(args...);
-            return QVariant();
-        };
-    } else if constexpr (std::is_convertible_v<R, QVariant>) {
-        f = [taskFunction](std::remove_reference_t<Args>... args) -> QVariant {
-            return taskFunction(args...);
-        };
-    } else if constexpr (QMetaTypeId<R>::Defined) {
-        f = [taskFunction](std::remove_reference_t<Args>... args) -> QVariant {
-            return QVariant::fromValue(taskFunction(args...));
-        };
+    TaskStopTimeout timeout = kDefaultStopTimeout;
+    auto taskInfoIt = m_taskHash.constFind(pTask->m_type);
+    if (taskInfoIt != m_taskHash.cend()) {
+        timeout = taskInfoIt.value().m_stopTimeout;
     } else {
-        qWarning() << "Core::registerTask - Not convertible return type for task type:" << taskType;
-        throw std::logic_error("Not convertible return type");
+        qWarning() << "Core::stopTask - Missing registration for active task type:" << pTask->m_type;
     }
 
-    insertToTaskHash(taskType, std::move(f), taskGroup, taskStopTimeout);
+    scheduleDeadline(DeadlineKind::StopTimeout, pTask->m_id, timeout);
 }
 
-template <typename R, typename... Args>
-void Core::registerTask(TaskType taskType, R (*taskFunction)(Args...), TaskGroup taskGroup, TaskStopTimeout taskStopTimeout) {
-    // Use deduction guide for std::function
-    registerTask(taskType, std::function(taskFunction), taskGroup, taskStopTimeout);
+inline void Core::scheduleDeadline(DeadlineKind kind, TaskId taskId, TaskStopTimeout timeout) {
+    if (!m_deadlineClock.isValid()) {
+        m_deadlineClock.start();
+    }
+    m_deadlines.push(Deadline{m_deadlineClock.elapsed() + timeout, kind, taskId, timeout});
+    armDeadlineTimer();
 }
 
-template <typename Class, typename R, typename... Args>
-void Core::registerTask(TaskType taskType, R (Class::*taskMethod)(Args...), Class* taskObj, TaskGroup taskGroup, TaskStopTimeout taskStopTimeout) {
-    if (taskObj == nullptr) {
-        qWarning() << "Core::registerTask - task object is null for task type:" << taskType;
-        throw std::logic_error("Task object is null");
+// The timer takes int milliseconds, so the entry of a deadline further out fires early; its handler
+// re-checks the QDeadlineTimer and schedules the rest.
+inline void Core::scheduleDeadline(DeadlineKind kind, TaskId taskId, const QDeadlineTimer& deadline) {
+    const qint64 remainingMs = std::max<qint64>(0, deadline.remainingTime());
+    scheduleDeadline(kind, taskId, static_cast<TaskStopTimeout>(std::min<qint64>(remainingMs, std::numeric_limits<TaskStopTimeout>::max())));
+}
+
+// Keeps the single deadline timer aimed at the earliest pending deadline.
+inline void Core::armDeadlineTimer() {
+    if (m_deadlines.empty()) {
+        if (m_pDeadlineTimer) {
+            m_pDeadlineTimer->stop();
+        }
+        return;
     }
 
-    // Direct call to bind_placeholders and registerTask with explicit std::function signature
-    auto boundFunc = bind_placeholders(taskMethod, taskObj, std::make_index_sequence<sizeof...(Args)>());
-    // Use deduction guide for std::function
-    registerTask(taskType, static_cast<std::function<R(Args...)>>(std::move(boundFunc)), taskGroup, taskStopTimeout);
+    if (!m_pDeadlineTimer) {
+        m_pDeadlineTimer = new QTimer(this); // with parent for automatic cleanup!
+        m_pDeadlineTimer->setSingleShot(true);
+        m_pDeadlineTimer->setTimerType(Qt::PreciseTimer);
+        connect(m_pDeadlineTimer, &QTimer::timeout, this, &Core::processDeadlines);
+    }
+
+    const qint64 dueMs = m_deadlines.top().m_dueMs;
+    if (m_pDeadlineTimer->isActive() && m_armedDeadlineMs <= dueMs) {
+        return;
+    }
+    m_armedDeadlineMs = dueMs;
+    m_pDeadlineTimer->start(static_cast<int>(std::max<qint64>(0, dueMs - m_deadlineClock.elapsed())));
 }
 
-template <typename Class, typename R, typename... Args>
-void Core::registerTask(TaskType taskType, R (Class::*taskMethod)(Args...) const, Class* taskObj, TaskGroup taskGroup, TaskStopTimeout taskStopTimeout) {
-    if (taskObj == nullptr) {
-        qWarning() << "Core::registerTask - task object is null for task type:" << taskType;
-        throw std::logic_error("Task object is null");
+inline void Core::processDeadlines() {
+    const qint64 nowMs = m_deadlineClock.elapsed();
+    while (!m_deadlines.empty() && m_deadlines.top().m_dueMs <= nowMs) {
+        const Deadline deadline = m_deadlines.top();
+        m_deadlines.pop();
+
+        switch (deadline.m_kind) {
+        case DeadlineKind::StopTimeout:
+            onStopTimeout(deadline.m_taskId, deadline.m_timeout);
+            break;
+        case DeadlineKind::TerminateTimeout:
+            onTerminateTimeout(deadline.m_taskId, deadline.m_timeout);
+            break;
+        case DeadlineKind::ResumeStarts:
+            if (m_activeTasks.isEmpty()) {
+                resumeStarts();
+            } else {
+                m_resumeStartsWhenIdle = true;
+            }
+            break;
+        case DeadlineKind::ShutdownEscalation:
+            if (m_shutdownState == ShutdownState::ShuttingDown && !m_shutdownEscalation.hasExpired()) {
+                scheduleDeadline(DeadlineKind::ShutdownEscalation, -1, m_shutdownEscalation);
+            } else if (m_shutdownState == ShutdownState::ShuttingDown) {
+                // Escalate only for stubborn tasks that ignored cooperative stop.
+                const auto stubbornTasks = m_activeTasks.values();
+                for (const auto& pTask : stubbornTasks) {
+                    terminateTask(pTask);
+                }
+            }
+            break;
+        case DeadlineKind::ShutdownDeadline:
+            if (m_shutdownState == ShutdownState::ShuttingDown && !m_shutdownDeadline.hasExpired()) {
+                scheduleDeadline(DeadlineKind::ShutdownDeadline, -1, m_shutdownDeadline);
+            } else if (m_shutdownState == ShutdownState::ShuttingDown) {
+                qWarning() << "Core::shutdown - deadline reached with active tasks:" << m_activeTasks.size();
+                finishShutdown();
+            }
+            break;
+        case DeadlineKind::TaskDeadline:
+            onTaskDeadline(deadline.m_taskId);
+            break;
+        case DeadlineKind::RateRefill: {
+            const TaskGroup group = static_cast<TaskGroup>(deadline.m_taskId);
+            if (auto limitIt = m_groupRateLimits.find(group); limitIt != m_groupRateLimits.end()) {
+                limitIt.value().m_refillScheduled = false;
+            }
+            startQueuedTask(group);
+            break;
+        }
+        }
     }
+    armDeadlineTimer();
+}
 
-    auto boundFunc = bind_placeholders(taskMethod, taskObj, std::make_index_sequence<sizeof...(Args)>());
-    // Use deduction guide for std::function
-    registerTask(taskType, static_cast<std::function<R(Args...)>>(std::move(boundFunc)), taskGroup, taskStopTimeout);
+inline void Core::scheduleTaskDeadline(const Task& task) {
+    scheduleDeadline(DeadlineKind::TaskDeadline, task.m_id, task.m_deadline);
 }
 
-// Generic overload (works for lambdas, functors)
-template <typename F>
-void Core::registerTask(TaskType taskType, F&& taskFunction, TaskGroup taskGroup, TaskStopTimeout taskStopTimeout) {
-    // Try to convert to std::function, relying on template argument deduction
-    // This works if F has an operator() with a unique signature
-    registerTask(taskType, std::function(std::forward<F>(taskFunction)), taskGroup, taskStopTimeout);
+// Tasks that already started, finished or left the queue otherwise have nothing left to expire.
+inline void Core::onTaskDeadline(TaskId taskId) {
+    const auto deadlineTaskIt = m_deadlineTasks.find(taskId);
+    if (deadlineTaskIt == m_deadlineTasks.end()) {
+        return;
+    }
+    const QSharedPointer<Task> pTask = deadlineTaskIt.value().toStrongRef();
+    if (!pTask.isNull() && (pTask->m_state == TaskState::Inactive || pTask->m_state == TaskState::Active)
+        && !pTask->m_deadline.hasExpired()) {
+        scheduleTaskDeadline(*pTask);
+        return;
+    }
+    m_deadlineTasks.erase(deadlineTaskIt);
+    if (pTask.isNull()) {
+        return;
+    }
+    if (pTask->m_state == TaskState::Inactive) {
+        if (removeQueuedTask(pTask)) {
+            reportExpiredTask(pTask);
+        }
+    } else if (pTask->m_state == TaskState::Active) {
+        stopTask(pTask);
+    }
 }
 
-inline bool Core::unregisterTask(TaskType taskType) {
-    if (!ensureCalledFromOwnerThread("unregisterTask")) {
-        return false;
+inline void Core::onStopTimeout(TaskId taskId, TaskStopTimeout timeout) {
+    QSharedPointer<Task> pTask = m_activeTasks.value(taskId);
+    if (pTask.isNull()) {
+        qDebug() << QString("Task %1 was successfully stopped").arg(QString::number(taskId));
+        return;
     }
 
-    for (const auto& pTask : std::as_const(m_activeTaskList)) {
-        if (pTask->m_type == taskType) {
-            qWarning() << "Core::unregisterTask - Cannot unregister active task type:" << taskType;
-            return false;
+    switch (pTask->m_state) {
+    case TaskState::Finished:
+        break;
+    case TaskState::Terminated:
+        qDebug() << QString("Task %1 was terminated").arg(QString::number(pTask->m_id));
+        break;
+    case TaskState::StopTimedOut:
+        qDebug() << QString("Task %1 stop already timed out").arg(QString::number(pTask->m_id));
+        break;
+    case TaskState::StopRequested:
+    case TaskState::Active:
+        if (!m_allowForceTermination) {
+            pTask->m_state = TaskState::StopTimedOut;
+            qWarning() << QString("Task %1 stop timed out; force termination is disabled").arg(QString::number(pTask->m_id));
+            reportStopTimedOut(pTask, timeout);
+            break;
         }
-    }
-    for (const auto& pTask : std::as_const(m_queuedTaskList)) {
-        if (pTask->m_type == taskType) {
-            qWarning() << "Core::unregisterTask - Cannot unregister queued task type:" << taskType;
-            return false;
+        qDebug() << QString("Task %1 was not stopped, terminating").arg(QString::number(pTask->m_id));
+        terminateTask(pTask);
+        if (pTask->m_state == TaskState::Active || pTask->m_state == TaskState::StopRequested) {
+            qDebug() << QString("Task %1 terminate request is in progress")
+                            .arg(QString::number(pTask->m_id));
         }
+        break;
+    default:
+        qDebug() << QString("Task %1 unexpected state").arg(QString::number(pTask->m_id));
+        break;
     }
-    return m_taskHash.remove(taskType) > 0;
 }
 
-template <typename... Args>
-void Core::addTask(TaskType taskType, Args... args) {
-    if (!ensureCalledFromOwnerThread("addTask")) {
-        throw std::logic_error("Core::addTask must be called from the owner thread");
+inline void Core::onTerminateTimeout(TaskId taskId, TaskStopTimeout timeout) {
+    QSharedPointer<Task> pTask = m_activeTasks.value(taskId);
+    if (pTask.isNull() || pTask->m_state == TaskState::Finished || pTask->m_state == TaskState::Terminated) {
+        return; // already finished/terminated by another path
     }
 
-    auto taskInfoIt = m_taskHash.constFind(taskType);
-    if (taskInfoIt == m_taskHash.cend()) {
-        qWarning() << "Core::addTask - Task not registered for type:" << taskType;
-        throw std::logic_error("Task not registered");
+#ifdef Q_OS_WIN
+    const bool isAlive = pTask->m_threadHandle && (WaitForSingleObject(pTask->m_threadHandle, 0) == WAIT_TIMEOUT);
+#else
+    const bool isAlive = (pTask->m_threadHandle != 0) && !pTask->m_threadExited.load();
+#endif
+    if (!isAlive) {
+        onTaskThreadExited(taskId);
+        return;
     }
 
-    try {
-        const auto& taskInfo = taskInfoIt.value();
-        auto storedFuncAny = taskInfo.m_function;
-        auto taskFunction = std::any_cast<std::function<QVariant(Args...)>>(storedFuncAny);
-
-        QList<QVariant> argsList;
-        if constexpr (all_convertible_to<QVariant>::check<Args...>()) {
-            argsList = { QVariant::fromValue(args)... };
-        } else {
-            qWarning() << "Core::addTask - Arguments are not convertible to QList<QVariant> for task type:" << taskType;
-        }
+    pTask->m_state = TaskState::StopTimedOut;
+    qWarning() << QString("Task %1 did not stop after terminate request within timeout (%2 ms)")
+                      .arg(QString::number(pTask->m_id)).arg(timeout);
+    reportStopTimedOut(pTask, timeout);
+}
 
-        auto taskFunctionBound = std::bind(taskFunction, args...);
-        auto pTask = QSharedPointer<Task>(new Task(
-            std::move(taskFunctionBound),
-            taskType,
-            taskInfo.m_group,
-            std::move(argsList)
-        ));
+// Reported for a task thread that was torn down before its task returned.
+inline void Core::onTaskThreadExited(TaskId taskId) {
+    QSharedPointer<Task> pTask = m_activeTasks.value(taskId);
+    if (pTask.isNull() || pTask->m_state == TaskState::Finished || pTask->m_state == TaskState::Terminated) {
+        return;
+    }
 
-        bool start = std::none_of(m_activeTaskList.begin(), m_activeTaskList.end(), [group = pTask->m_group](const auto& pActiveTask) {
-            return pActiveTask->m_group == group;
-        });
+#ifdef Q_OS_WIN
+    if (pTask->m_exitWaitHandle) {
+        UnregisterWait(pTask->m_exitWaitHandle);
+        pTask->m_exitWaitHandle = nullptr;
+    }
+    if (pTask->m_threadHandle) {
+        CloseHandle(pTask->m_threadHandle);
+        pTask->m_threadHandle = nullptr;
+    }
+#endif
+    reportTerminated(pTask);
+}
 
-        if (start && !m_blockStartTask.load()) {
-            startTask(pTask);
-        } else {
-            m_queuedTaskList.append(std::move(pTask));
+#ifndef Q_OS_WIN
+// Without the pipe, a canceled thread is still noticed through m_threadExited when its stop timeout expires.
+inline TaskThreadExitQueue* Core::threadExitQueue() {
+    if (!m_pThreadExitNotifier) {
+        if (!m_threadExitQueue.open()) {
+            qWarning() << "Core::startTask - Failed to create the thread exit pipe. errno:" << errno;
+            return nullptr;
         }
-    } catch (const std::bad_any_cast& e) {
-        qWarning() << "Core::addTask - Bad arguments or function signature mismatch for task type:" << taskType << e.what();
-        throw std::logic_error("Bad arguments or function signature mismatch");
+        m_pThreadExitNotifier = new QSocketNotifier(m_threadExitQueue.readDescriptor(), QSocketNotifier::Read, this);
+        connect(m_pThreadExitNotifier, &QSocketNotifier::activated, this, [this]() { onTaskThreadsExited(); });
     }
+    return &m_threadExitQueue;
 }
 
-[[nodiscard]] inline std::atomic_bool* Core::stopTaskFlag() {
-    return core_detail::g_currentStopFlag;
+// Slots of canceled threads are never released, so each helper still points at its task.
+inline void Core::onTaskThreadsExited() {
+    const QVector<TaskHelper*> exitedHelpers = m_threadExitQueue.takeAll();
+    for (TaskHelper* pTaskHelper : exitedHelpers) {
+        if (QSharedPointer<Task> pTask = m_taskHelperSlots[pTaskHelper->slotIndex()].m_pTask) {
+            onTaskThreadExited(pTask->m_id);
+        }
+    }
 }
+#endif
 
-inline void Core::terminateTaskById(TaskId id) {
-    if (!ensureCalledFromOwnerThread("terminateTaskById")) {
-        return;
+inline void Core::reportTerminated(const QSharedPointer<Task>& pTask) {
+    pTask->m_state = TaskState::Terminated;
+    // The killed thread keeps the task record pinned, so its handle is canceled here rather than in ~Task.
+    if (pTask->m_pHandleState) {
+        pTask->m_pHandleState->cancel();
     }
+    recordTaskEnded(*pTask, false);
+    emit terminatedTask(pTask->m_id, pTask->m_type, pTask->m_argsList);
+    resolveCacheWaiters(pTask, nullptr, nullptr);
+    removeActiveTask(pTask);
+    startQueuedTask(pTask->m_group);
+}
 
-    if (auto pTask = activeTaskById(id); !pTask.isNull()) {
-        if (!m_allowForceTermination) {
-            qWarning() << "Core::terminateTaskById - force termination is disabled. Requesting cooperative stop for task ID:" << id;
-            stopTaskById(id);
-            return;
-        }
-        terminateTask(std::move(pTask));
-    }
+// For tasks taken out of a queue before they started.
+inline void Core::reportDroppedTask(const QSharedPointer<Task>& pTask) {
+    pTask->trace(core_detail::TraceEventKind::Dropped);
+    updateMetrics(*pTask, [](TaskMetrics& metrics) { ++metrics.dropped; });
+    emit terminatedTask(pTask->m_id, pTask->m_type, pTask->m_argsList);
+    resolveCacheWaiters(pTask, nullptr, nullptr);
 }
 
-inline void Core::setAllowForceTermination(bool allow) {
-    if (!ensureCalledFromOwnerThread("setAllowForceTermination")) {
-        return;
-    }
-    m_allowForceTermination = allow;
+inline void Core::reportExpiredTask(const QSharedPointer<Task>& pTask) {
+    pTask->trace(core_detail::TraceEventKind::Expired);
+    updateMetrics(*pTask, [](TaskMetrics& metrics) { ++metrics.expired; });
+    emit expiredTask(pTask->m_id, pTask->m_type, pTask->m_argsList);
+    resolveCacheWaiters(pTask, nullptr, nullptr);
 }
 
-inline bool Core::allowForceTermination() const {
-    if (!ensureCalledFromOwnerThread("allowForceTermination")) {
-        return false;
-    }
-    return m_allowForceTermination;
+inline void Core::reportStopTimedOut(const QSharedPointer<Task>& pTask, TaskStopTimeout timeout) {
+    pTask->trace(core_detail::TraceEventKind::StopTimedOut);
+    updateMetrics(*pTask, [](TaskMetrics& metrics) { ++metrics.stopTimeouts; });
+    emit stopTimedOutTask(pTask->m_id, pTask->m_type, pTask->m_argsList, timeout);
 }
 
-inline void Core::cancelTaskById(TaskId id) {
-    if (!ensureCalledFromOwnerThread("cancelTaskById")) {
+template <typename F>
+void Core::updateMetrics(const Task& task, F&& update) {
+    if (!m_pMetrics || !task.m_timed) {
         return;
     }
-    stopTaskById(id);
+    update(m_pMetrics->total);
+    update(m_pMetrics->byType[task.m_type]);
+    update(m_pMetrics->byGroup[task.m_group]);
 }
 
-inline void Core::cancelTaskByType(TaskType type) {
-    if (!ensureCalledFromOwnerThread("cancelTaskByType")) {
+// A pooled task traces its start from execute() and is counted by recordTaskEnded from m_runStartUs.
+inline void Core::recordTaskStarted(const Task& task) {
+    if (task.m_pooled) {
         return;
     }
-    stopTaskByType(type);
-}
-
-inline void Core::cancelTaskByGroup(TaskGroup group) {
-    if (!ensureCalledFromOwnerThread("cancelTaskByGroup")) {
+    task.trace(core_detail::TraceEventKind::Started);
+    if (!task.m_timed) {
         return;
     }
-    stopTaskByGroup(group);
+    const qint64 waitUs = core_detail::steadyMicros() - task.m_admittedUs;
+    updateMetrics(task, [waitUs](TaskMetrics& metrics) {
+        ++metrics.started;
+        metrics.queueWait.record(waitUs);
+    });
 }
 
-inline void Core::cancelTasks() {
-    if (!ensureCalledFromOwnerThread("cancelTasks")) {
+// finished is false for a terminated task, whose run end was never recorded.
+inline void Core::recordTaskEnded(const Task& task, bool finished) {
+    task.trace(finished ? core_detail::TraceEventKind::Finished : core_detail::TraceEventKind::Terminated);
+    if (!task.m_timed) {
         return;
     }
-    stopTasks();
+    const qint64 runStartUs = task.m_runStartUs.load();
+    const qint64 runEndUs = finished ? task.m_runEndUs.load() : core_detail::steadyMicros();
+    const qint64 stopRequestedUs = task.m_stopRequestedUs;
+    const bool pooledStarted = task.m_pooled && runStartUs != 0;
+    const qint64 admittedUs = task.m_admittedUs;
+    updateMetrics(task, [&](TaskMetrics& metrics) {
+        if (pooledStarted) {
+            ++metrics.started;
+            metrics.queueWait.record(runStartUs - admittedUs);
+        }
+        if (finished) {
+            ++metrics.finished;
+        } else {
+            ++metrics.terminated;
+        }
+        if (runStartUs != 0 && runEndUs != 0) {
+            metrics.runTime.record(runEndUs - runStartUs);
+        }
+        if (stopRequestedUs != 0 && runEndUs != 0) {
+            metrics.stopLatency.record(runEndUs - stopRequestedUs);
+        }
+    });
 }
 
-inline void Core::cancelAllTasks() {
-    if (!ensureCalledFromOwnerThread("cancelAllTasks")) {
-        return;
+// Empty when the arguments were not captured (not QVariant-convertible); the task then runs uncached.
+inline QByteArray Core::resultCacheKey(const QList<QVariant>& argsList, int argCount) {
+    if (argsList.size() != argCount) {
+        return {};
     }
-    stopAllTasks();
+    QByteArray key;
+    QDataStream stream(&key, QIODevice::WriteOnly);
+    stream << argsList; // starts with the count, so even a task without arguments gets a non-empty key
+    return stream.status() == QDataStream::Ok ? key : QByteArray();
 }
 
-inline void Core::cancelTasksByGroup(TaskGroup group, bool includeQueued) {
-    if (!ensureCalledFromOwnerThread("cancelTasksByGroup")) {
-        return;
-    }
-    stopTasksByGroup(group, includeQueued);
+// A cache hit is still reported asynchronously, as if the task had run.
+inline void Core::deliverCachedResult(TaskId id, TaskType taskType, const QList<QVariant>& argsList, const QVariant& result, ResultDelivery delivery) {
+    QMetaObject::invokeMethod(this, [this, id, taskType, argsList, result, delivery]() {
+        if (delivery == ResultDelivery::Batched) {
+            emit finishedTasks({ TaskResult{id, taskType, argsList, result} });
+        } else {
+            emit finishedTask(id, taskType, argsList, result);
+        }
+    }, Qt::QueuedConnection);
 }
 
-inline void Core::stopTaskById(TaskId id) {
-    if (!ensureCalledFromOwnerThread("stopTaskById")) {
+// Attached duplicates share the outcome of their run; a stopped run is neither cached nor shared.
+inline void Core::resolveCacheWaiters(const QSharedPointer<Task>& pTask, const QVariant* pResult, QVector<TaskResult>* pBatch) {
+    if (pTask->m_cacheKey.isEmpty()) {
+        return;
+    }
+    ResultCache& cache = *pTask->m_pResultCache;
+    const QByteArray cacheKey = std::exchange(pTask->m_cacheKey, QByteArray());
+    QVector<TaskId> waiters = cache.m_inFlight.take(cacheKey);
+    const bool shareResult = (pResult != nullptr) && !pTask->m_stopFlag.load();
+    if (shareResult) {
+        cache.m_results.insert(cacheKey, new QVariant(*pResult));
+    } else if (handOffCachedRun(pTask, cacheKey, waiters)) {
         return;
     }
 
-    if (auto pTask = activeTaskById(id); !pTask.isNull()) {
-        stopTask(std::move(pTask));
+    for (TaskId waiterId : std::as_const(waiters)) {
+        m_cacheDuplicates.remove(waiterId);
+        if (!shareResult) {
+            emit terminatedTask(waiterId, pTask->m_type, pTask->m_argsList);
+        } else if (pBatch) {
+            pBatch->append(TaskResult{waiterId, pTask->m_type, pTask->m_argsList, *pResult});
+        } else {
+            emit finishedTask(waiterId, pTask->m_type, pTask->m_argsList, *pResult);
+        }
     }
 }
 
-inline void Core::stopTaskByType(TaskType type) {
-    if (!ensureCalledFromOwnerThread("stopTaskByType")) {
-        return;
+// Stopping one run must not take its duplicates down with it: the oldest one becomes a task of its own,
+// and the others attach to it. Only a shutdown, or a type whose arguments cannot be rebound, ends them all.
+inline bool Core::handOffCachedRun(const QSharedPointer<Task>& pTask, const QByteArray& cacheKey, QVector<TaskId>& waiters) {
+    if (waiters.isEmpty() || m_shutdownState != ShutdownState::Running) {
+        return false;
+    }
+    auto taskInfoIt = m_taskHash.constFind(pTask->m_type);
+    if (taskInfoIt == m_taskHash.cend() || !taskInfoIt.value().m_restoreFunction) {
+        return false;
+    }
+    std::function<QVariant()> function = taskInfoIt.value().m_restoreFunction(pTask->m_argsList);
+    if (!function) {
+        return false;
     }
 
-    if (auto pTask = activeTaskByType(type); !pTask.isNull()) {
-        stopTask(std::move(pTask));
+    const TaskId nextId = waiters.takeFirst();
+    m_cacheDuplicates.remove(nextId);
+    auto pNextTask = createTask(std::move(function), nextId, pTask->m_type, pTask->m_group, pTask->m_argsList);
+    pNextTask->m_priority = pTask->m_priority;
+    pNextTask->m_pResultCache = pTask->m_pResultCache;
+    pNextTask->m_cacheKey = cacheKey;
+    pTask->m_pResultCache->m_inFlight.insert(cacheKey, std::move(waiters));
+    admitTask(std::move(pNextTask));
+    return true;
+}
+
+inline bool Core::dropCacheDuplicate(TaskId id) {
+    auto duplicateIt = m_cacheDuplicates.find(id);
+    if (duplicateIt == m_cacheDuplicates.end()) {
+        return false;
     }
+    const CacheDuplicate duplicate = std::move(duplicateIt.value());
+    m_cacheDuplicates.erase(duplicateIt);
+    if (auto inFlightIt = duplicate.m_pCache->m_inFlight.find(duplicate.m_cacheKey); inFlightIt != duplicate.m_pCache->m_inFlight.end()) {
+        inFlightIt.value().removeOne(id);
+    }
+    emit terminatedTask(id, duplicate.m_type, duplicate.m_argsList);
+    return true;
 }
 
-inline void Core::stopTaskByGroup(TaskGroup group) {
-    if (!ensureCalledFromOwnerThread("stopTaskByGroup")) {
-        return;
+// Duplicates count as queued: they go wherever the queued tasks of their group go.
+inline void Core::dropCacheDuplicates(std::optional<TaskGroup> group) {
+    QVector<TaskId> ids;
+    for (auto duplicateIt = m_cacheDuplicates.cbegin(); duplicateIt != m_cacheDuplicates.cend(); ++duplicateIt) {
+        if (!group || duplicateIt.value().m_group == *group) {
+            ids.append(duplicateIt.key());
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+    for (TaskId id : std::as_const(ids)) {
+        dropCacheDuplicate(id);
     }
+}
 
-    stopTasksByGroup(group, false);
+#ifdef Q_OS_WIN
+inline VOID CALLBACK Core::threadHandleSignaled(PVOID pContext, BOOLEAN timedOut) {
+    Q_UNUSED(timedOut);
+    auto* pWatch = static_cast<ThreadExitWatch*>(pContext);
+    Core* pCore = pWatch->m_pCore;
+    const TaskId taskId = pWatch->m_taskId;
+    delete pWatch;
+    QMetaObject::invokeMethod(pCore, [pCore, taskId]() { pCore->onTaskThreadExited(taskId); }, Qt::QueuedConnection);
+}
+#endif
+
+inline void Core::resumeStarts() {
+    m_resumeStartsWhenIdle = false;
+    if (m_shutdownState != ShutdownState::Running) {
+        return;
+    }
+    m_blockStartTask.store(false);
+    startQueuedTasks();
 }
 
-inline void Core::stopTasks() {
-    if (!ensureCalledFromOwnerThread("stopTasks")) {
+inline void Core::startTask(QSharedPointer<Core::Task> pTask) {
+    insertActiveTask(pTask);
+    pTask->m_state = TaskState::Active;
+    pTask->m_threadExited.store(false);
+    // From here on a token cancel() sets the flag itself; ~Task unregisters it.
+    if (pTask->m_pCancellation) {
+        pTask->m_pCancellation->registerStopFlag(&pTask->m_stopFlag);
+    }
+    // The helper only borrows the task: pTask stays alive in the helper slot until finished arrives.
+    const int slotIndex = acquireTaskHelperSlot();
+    TaskHelperSlot& helperSlot = m_taskHelperSlots[slotIndex];
+    helperSlot.m_pTask = pTask;
+    TaskHelper* pTaskHelper = helperSlot.m_pHelper;
+    auto taskInfoIt = m_taskHash.constFind(pTask->m_type);
+    const bool batchedResult = (taskInfoIt != m_taskHash.cend()) && (taskInfoIt.value().m_resultDelivery == ResultDelivery::Batched);
+    TaskThreadExitQueue* pThreadExitQueue = nullptr;
+    // Pool workers apply their policy once; a dedicated thread applies it before running the task.
+    if (!m_pWorkerPool) {
+#ifndef Q_OS_WIN
+        pThreadExitQueue = threadExitQueue();
+#endif
+        if (!m_groupThreadPolicies.isEmpty()) {
+            pTask->m_pThreadPolicy = m_groupThreadPolicies.value(pTask->m_group);
+        }
+    }
+    // Capturing only the task keeps the callable in std::function's inline buffer.
+    pTaskHelper->bind([pRawTask = pTask.data()]() {
+        if (pRawTask->m_pThreadPolicy) {
+            core_detail::applyCurrentThreadPolicy(*pRawTask->m_pThreadPolicy);
+        }
+        return pRawTask->execute();
+    }, &pTask->m_stopFlag, &pTask->m_threadExited, batchedResult ? &m_completionQueue : nullptr, pThreadExitQueue);
+
+    if (m_pWorkerPool) {
+        pTask->m_pooled = true;
+        TaskWorkerPool* pWorkerPool = m_pWorkerPool.get();
+        if (auto groupPoolIt = m_groupWorkerPools.constFind(pTask->m_group); groupPoolIt != m_groupWorkerPools.cend()) {
+            pWorkerPool = groupPoolIt.value().data();
+        }
+        pWorkerPool->submit([pTaskHelper]() {
+            pTaskHelper->execute();
+        });
+        recordTaskStarted(*pTask);
+        emit startedTask(pTask->m_id, pTask->m_type, pTask->m_argsList);
         return;
     }
 
-    if (m_activeTaskList.isEmpty()) {
-        return;
+#ifdef Q_OS_WIN
+    const std::size_t stackSize = pTask->m_pThreadPolicy ? pTask->m_pThreadPolicy->stackSize : 0;
+    pTask->m_threadHandle = core_detail::createThread(stackSize, &TaskHelper::functionWrapper, pTaskHelper, &pTask->m_threadId);
+    if (pTask->m_threadHandle == NULL) {
+        qWarning() << "Core::startTask - Failed to create thread for task ID:" << pTask->m_id << ". GetLastError:" << GetLastError();
+        updateMetrics(*pTask, [](TaskMetrics& metrics) { ++metrics.startFailures; });
+        removeActiveTask(pTask);
+        // emit taskCreationFailed(...);
+        releaseTaskHelperSlot(slotIndex);
+        startQueuedTask(pTask->m_group);
+        return; // Abort StartTask execution
+    }
+    // If everything is OK, continue...
+#else
+    // Checking pthread_create
+    int result = core_detail::createThread(&pTask->m_threadHandle, pTask->m_pThreadPolicy ? pTask->m_pThreadPolicy->stackSize : 0, &TaskHelper::functionWrapper, pTaskHelper);
+    if (result != 0) {
+        qWarning() << "Core::startTask - Failed to create thread for task ID:" << pTask->m_id << ". Error code:" << result;
+        updateMetrics(*pTask, [](TaskMetrics& metrics) { ++metrics.startFailures; });
+        removeActiveTask(pTask);
+        // emit taskCreationFailed(...);
+        releaseTaskHelperSlot(slotIndex);
+        startQueuedTask(pTask->m_group);
+        return; // Abort StartTask execution
+    }
+    // If everything is OK, continue...
+    pthread_detach(pTask->m_threadHandle);
+#endif
+
+    recordTaskStarted(*pTask);
+    emit startedTask(pTask->m_id, pTask->m_type, pTask->m_argsList);
+}
+
+// Helpers are parented to Core and reused; a new one is created only when every slot is busy.
+inline int Core::acquireTaskHelperSlot() {
+    if (!m_idleTaskHelperSlots.isEmpty()) {
+        return m_idleTaskHelperSlots.takeLast();
     }
 
-    m_blockStartTask.store(true);
-    QTimer* pTimer = new QTimer(this); // with parent for automatic cleanup!
-    connect(pTimer, &QTimer::timeout, this, [this, pTimer]() {
-        if (isIdle()) { // Use the public method
-            m_blockStartTask.store(false);
-            startQueuedTask();
-            pTimer->stop();
-            pTimer->deleteLater();
-        }
+    const int slotIndex = m_taskHelperSlots.size();
+    TaskHelperSlot helperSlot;
+    helperSlot.m_pHelper = new TaskHelper(slotIndex, &m_taskExitSignal, this); // Add with parent!
+    connect(helperSlot.m_pHelper, &TaskHelper::finished, this, [this, slotIndex](QVariant result) {
+        onTaskHelperFinished(slotIndex, std::move(result));
     });
+    m_taskHelperSlots.append(std::move(helperSlot));
+    return slotIndex;
+}
 
-    // Calculating the maximum stop timeout among active tasks
-    TaskStopTimeout maxTimeout = 0;
-    for (const auto& pTask : std::as_const(m_activeTaskList)) {
-        auto taskInfoIt = m_taskHash.constFind(pTask->m_type);
-        if (taskInfoIt != m_taskHash.cend()) {
-            maxTimeout = std::max(maxTimeout, taskInfoIt.value().m_stopTimeout);
-        } else {
-            maxTimeout = std::max(maxTimeout, static_cast<TaskStopTimeout>(kDefaultStopTimeout));
-            qWarning() << "Core::stopTasks - Missing registration for active task type:" << pTask->m_type;
-        }
-    }
+inline void Core::releaseTaskHelperSlot(int slotIndex) {
+    TaskHelperSlot& helperSlot = m_taskHelperSlots[slotIndex];
+    helperSlot.m_pHelper->bind({}, nullptr, nullptr);
+    helperSlot.m_pTask.reset();
+    m_idleTaskHelperSlots.append(slotIndex);
+}
 
-    // Requesting to stop all active tasks
-    for (const auto& pTask : std::as_const(m_activeTaskList)) {
-        stopTask(pTask);
+// Slots of terminated threads are never released: the killed thread may not have unwound the task yet.
+inline void Core::onTaskHelperFinished(int slotIndex, QVariant result) {
+    QSharedPointer<Task> pTask = m_taskHelperSlots[slotIndex].m_pTask;
+    releaseTaskHelperSlot(slotIndex);
+    if (!pTask || pTask->m_state == TaskState::Terminated) {
+        return; // already reported by the terminate path
     }
 
-    // Starting the timer with the maximum timeout
-    pTimer->start(maxTimeout);
+    pTask->m_state = TaskState::Finished;
+    recordTaskEnded(*pTask, true);
+    emit finishedTask(pTask->m_id, pTask->m_type, pTask->m_argsList, result);
+    resolveCacheWaiters(pTask, &result, nullptr);
+    removeActiveTask(pTask);
+    startQueuedTask(pTask->m_group);
 }
 
-inline void Core::stopAllTasks() {
-    if (!ensureCalledFromOwnerThread("stopAllTasks")) {
+inline void Core::scheduleFinishedTasksFlush() {
+    if (m_resultFlushInterval <= 0) {
+        flushFinishedTasks();
         return;
     }
 
-    // Remove queued tasks immediately (they never started, so no stop timeout needed).
-    for (const auto& pQueuedTask : std::as_const(m_queuedTaskList)) {
-        emit terminatedTask(pQueuedTask->m_id, pQueuedTask->m_type, pQueuedTask->m_argsList);
+    if (!m_pResultFlushTimer) {
+        m_pResultFlushTimer = new QTimer(this);
+        m_pResultFlushTimer->setSingleShot(true);
+        connect(m_pResultFlushTimer, &QTimer::timeout, this, &Core::flushFinishedTasks);
+    }
+    if (!m_pResultFlushTimer->isActive()) {
+        m_pResultFlushTimer->start(m_resultFlushInterval);
     }
-    m_queuedTaskList.clear();
-
-    // Then request stop for all currently active tasks.
-    stopTasks();
 }
 
-inline void Core::stopTasksByGroup(TaskGroup group, bool includeQueued) {
-    if (!ensureCalledFromOwnerThread("stopTasksByGroup")) {
+// Reports every batched completion collected so far through one finishedTasks signal.
+inline void Core::flushFinishedTasks() {
+    const QVector<TaskHelper*> finishedHelpers = m_completionQueue.takeAll();
+    if (finishedHelpers.isEmpty()) {
         return;
     }
 
-    QList<QSharedPointer<Task>> activeInGroup;
-    for (const auto& pTask : std::as_const(m_activeTaskList)) {
-        if (pTask->m_group == group) {
-            activeInGroup.append(pTask);
+    QVector<TaskResult> results;
+    results.reserve(finishedHelpers.size());
+    QVector<TaskGroup> freedGroups;
+    for (TaskHelper* pTaskHelper : finishedHelpers) {
+        QVariant result = pTaskHelper->takeResult();
+        const int slotIndex = pTaskHelper->slotIndex();
+        QSharedPointer<Task> pTask = m_taskHelperSlots[slotIndex].m_pTask;
+        releaseTaskHelperSlot(slotIndex);
+        if (!pTask || pTask->m_state == TaskState::Terminated) {
+            continue; // already reported by the terminate path
         }
-    }
 
-    for (const auto& pTask : std::as_const(activeInGroup)) {
-        stopTask(pTask);
+        pTask->m_state = TaskState::Finished;
+        recordTaskEnded(*pTask, true);
+        resolveCacheWaiters(pTask, &result, &results);
+        results.append(TaskResult{pTask->m_id, pTask->m_type, pTask->m_argsList, std::move(result)});
+        removeActiveTask(pTask);
+        if (!freedGroups.contains(pTask->m_group)) {
+            freedGroups.append(pTask->m_group);
+        }
     }
 
-    if (!includeQueued) {
-        return;
+    if (!results.isEmpty()) {
+        emit finishedTasks(results);
     }
-
-    for (auto it = m_queuedTaskList.begin(); it != m_queuedTaskList.end();) {
-        const auto& pQueuedTask = *it;
-        if (pQueuedTask->m_group == group) {
-            emit terminatedTask(pQueuedTask->m_id, pQueuedTask->m_type, pQueuedTask->m_argsList);
-            it = m_queuedTaskList.erase(it);
-        } else {
-            ++it;
-        }
+    for (TaskGroup group : std::as_const(freedGroups)) {
+        startQueuedTask(group);
     }
 }
 
-[[nodiscard]] inline bool Core::isTaskRegistered(TaskType type) {
-    if (!ensureCalledFromOwnerThread("isTaskRegistered")) {
-        return false;
-    }
+// Promotes queued tasks of a single group while it has free slots; called when that group has just freed up.
+inline void Core::startQueuedTask(TaskGroup group) {
+    while (!m_blockStartTask.load() && !isGroupBusy(group)) {
+        refillSpilledTasks(group);
+        auto queueIt = m_queuedTasksByGroup.find(group);
+        if (queueIt == m_queuedTasksByGroup.end() || !takeRateToken(group, true)) {
+            return;
+        }
 
-    return m_taskHash.contains(type);
+        // The first entry has the lowest rank: the highest-priority task once aging is accounted for.
+        auto headIt = queueIt.value().begin();
+        QSharedPointer<Task> pQueuedTask = headIt.value();
+        queueIt.value().erase(headIt);
+        if (queueIt.value().isEmpty()) {
+            m_queuedTasksByGroup.erase(queueIt);
+        }
+        releaseQueuedTask(pQueuedTask);
+        // The deadline timer may not have fired yet; canceled tokens are only noticed here.
+        if (!pQueuedTask->m_deadline.isForever() && pQueuedTask->m_deadline.hasExpired()) {
+            returnRateToken(group);
+            reportExpiredTask(pQueuedTask);
+            continue;
+        }
+        if (pQueuedTask->m_pCancellation && pQueuedTask->m_pCancellation->isCanceled()) {
+            returnRateToken(group);
+            reportDroppedTask(pQueuedTask);
+            continue;
+        }
+        startTask(std::move(pQueuedTask));
+    }
 }
 
-inline TaskGroup Core::groupByTask(TaskType type, bool* ok) {
-    if (!ensureCalledFromOwnerThread("groupByTask")) {
-        if (ok) *ok = false;
-        return -1;
+// Promotes every group that can run, lowest-ranked head first; used when a global start block is lifted.
+inline void Core::startQueuedTasks() {
+    if (m_blockStartTask.load()) {
+        return;
     }
 
-    auto taskInfoIt = m_taskHash.constFind(type);
-    if (taskInfoIt != m_taskHash.cend()) {
-        if (ok) *ok = true;
-        return taskInfoIt.value().m_group;
-    } else {
-        if (ok) *ok = false;
-        return -1;
+    QMap<QueueKey, TaskGroup> groupsByHead;
+    for (auto queueIt = m_queuedTasksByGroup.cbegin(); queueIt != m_queuedTasksByGroup.cend(); ++queueIt) {
+        groupsByHead.insert(queueIt.value().firstKey(), queueIt.key());
+    }
+    for (TaskGroup group : std::as_const(groupsByHead)) {
+        startQueuedTask(group);
     }
 }
 
-[[nodiscard]] inline bool Core::isIdle() {
-    if (!ensureCalledFromOwnerThread("isIdle")) {
+inline bool Core::isSpillCaptureNeeded(TaskGroup group) const {
+    return !m_groupSpills.isEmpty() && m_groupSpills.contains(group);
+}
+
+// Validates the header and counts the complete records after the consumed offset; a record cut short
+// by a crash is truncated away.
+// Refuses a file with records it could not rebuild, so registering the task types of the group first
+// is all it takes to resume an earlier backlog; nothing is dropped for being opened too early.
+inline bool Core::openGroupSpill(TaskGroup group, GroupSpill& spill, const QString& filePath) {
+    auto pFile = QSharedPointer<QFile>::create(filePath);
+    if (!pFile->open(QIODevice::ReadWrite)) {
+        qWarning() << "Core::setGroupQueueSpill - Cannot open spill file:" << filePath << pFile->errorString();
         return false;
     }
+    spill.m_pFile = pFile;
+    spill.m_readOffset = kSpillHeaderSize;
+    spill.m_writeOffset = kSpillHeaderSize;
+
+    const qint64 fileSize = pFile->size();
+    if (fileSize == 0) {
+        spill.m_resumedEnd = kSpillHeaderSize;
+        writeSpillHeader(spill);
+        return true;
+    }
 
-    return m_activeTaskList.isEmpty();
-}
-
-[[nodiscard]] inline bool Core::isTaskAddedByType(TaskType type, bool* isActive) {
-    if (!ensureCalledFromOwnerThread("isTaskAddedByType")) {
-        if (isActive) *isActive = false;
+    uchar* pData = (fileSize >= kSpillHeaderSize) ? pFile->map(0, fileSize) : nullptr;
+    if (pData == nullptr
+        || qFromLittleEndian<quint32>(pData) != kSpillMagic
+        || qFromLittleEndian<quint32>(pData + 4) != kSpillVersion) {
+        qWarning() << "Core::setGroupQueueSpill - Not a task spill file:" << filePath;
+        if (pData != nullptr) {
+            pFile->unmap(pData);
+        }
         return false;
     }
 
-    for (const auto& pTask : std::as_const(m_activeTaskList)) {
-        if (pTask->m_type == type) {
-            if (isActive) *isActive = true;
-            return true;
+    const qint64 consumedOffset = std::clamp<qint64>(static_cast<qint64>(qFromLittleEndian<quint64>(pData + 8)), kSpillHeaderSize, fileSize);
+    QHash<TaskType, int> countByType;
+    qint64 offset = consumedOffset;
+    qint64 recordCount = 0;
+    while (offset + 4 <= fileSize) {
+        const qint64 payloadSize = qFromLittleEndian<quint32>(pData + offset);
+        if (offset + 4 + payloadSize > fileSize) {
+            break;
         }
+        // The payload starts with the qint64 id and the qint32 type, big-endian as QDataStream writes them.
+        if (payloadSize >= 12) {
+            ++countByType[qFromBigEndian<qint32>(pData + offset + 4 + 8)];
+        }
+        ++recordCount;
+        offset += 4 + payloadSize;
     }
-    for (const auto& pTask : std::as_const(m_queuedTaskList)) {
-        if (pTask->m_type == type) {
-            if (isActive) *isActive = false;
-            return true;
+    pFile->unmap(pData);
+    for (auto countIt = countByType.cbegin(); countIt != countByType.cend(); ++countIt) {
+        auto taskInfoIt = m_taskHash.constFind(countIt.key());
+        if (taskInfoIt == m_taskHash.cend() || taskInfoIt.value().m_group != group || !taskInfoIt.value().m_restoreFunction) {
+            qWarning() << "Core::setGroupQueueSpill - Spill file" << filePath << "holds" << countIt.value()
+                       << "tasks of type" << countIt.key() << "that is not registered in group" << group << "with QVariant-convertible parameters";
+            return false;
         }
     }
-    return false;
+    if (offset < fileSize) {
+        qWarning() << "Core::setGroupQueueSpill - Truncating incomplete record in:" << filePath;
+        pFile->resize(offset);
+    }
+
+    spill.m_readOffset = (recordCount > 0) ? consumedOffset : kSpillHeaderSize;
+    spill.m_writeOffset = (recordCount > 0) ? offset : kSpillHeaderSize;
+    spill.m_resumedEnd = spill.m_writeOffset;
+    spill.m_pendingRecords = recordCount;
+    if (recordCount == 0) {
+        pFile->resize(kSpillHeaderSize);
+    }
+    writeSpillHeader(spill);
+    for (auto countIt = countByType.cbegin(); countIt != countByType.cend(); ++countIt) {
+        m_queuedCountByType[countIt.key()] += countIt.value();
+    }
+    m_queuedTaskCount += static_cast<int>(recordCount);
+    return true;
 }
 
-[[nodiscard]] inline bool Core::isTaskAddedByGroup(TaskGroup group, bool* isActive) {
-    if (!ensureCalledFromOwnerThread("isTaskAddedByGroup")) {
-        if (isActive) *isActive = false;
+// Appends the task when the group's in-memory queue is full, or behind tasks that are already spilled.
+// Only tasks that can be rebuilt from their type and arguments qualify.
+inline bool Core::spillTask(const QSharedPointer<Task>& pTask) {
+    auto spillIt = m_groupSpills.find(pTask->m_group);
+    if (spillIt == m_groupSpills.end()) {
         return false;
     }
-
-    for (const auto& pTask : std::as_const(m_activeTaskList)) {
-        if (pTask->m_group == group) {
-            if (isActive) *isActive = true;
-            return true;
+    GroupSpill& spill = spillIt.value();
+    if (spill.m_pendingRecords == 0) {
+        auto queueIt = m_queuedTasksByGroup.constFind(pTask->m_group);
+        if (queueIt == m_queuedTasksByGroup.cend() || queueIt.value().size() < spill.m_maxInMemoryTasks) {
+            return false;
         }
     }
-    for (const auto& pTask : std::as_const(m_queuedTaskList)) {
-        if (pTask->m_group == group) {
-            if (isActive) *isActive = false;
-            return true;
-        }
+    // Handles, deadlines, tokens and cache waiters only exist in this process.
+    if (pTask->m_pHandleState || !pTask->m_deadline.isForever() || pTask->m_pCancellation || pTask->m_pResultCache) {
+        return false;
+    }
+    auto taskInfoIt = m_taskHash.constFind(pTask->m_type);
+    if (taskInfoIt == m_taskHash.cend() || !taskInfoIt.value().m_restoreFunction
+        || pTask->m_argsList.size() != taskInfoIt.value().m_argCount) {
+        return false;
     }
-    return false;
-}
 
-// --- Internal method implementations (inline) ---
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_12);
+    stream << static_cast<qint64>(pTask->m_id) << static_cast<qint32>(pTask->m_type)
+           << static_cast<qint32>(pTask->m_priority) << static_cast<qint64>(pTask->m_admittedUs) << pTask->m_argsList;
+    if (stream.status() != QDataStream::Ok) {
+        return false;
+    }
 
-inline QSharedPointer<Core::Task> Core::activeTaskById(TaskId id) {
-    auto it = std::find_if(m_activeTaskList.begin(), m_activeTaskList.end(),
-                           [id](const auto& pTask) { return pTask->m_id == id; });
-    return (it != m_activeTaskList.end()) ? *it : QSharedPointer<Task>{};
+    char sizeBytes[4];
+    qToLittleEndian<quint32>(static_cast<quint32>(payload.size()), sizeBytes);
+    QFile& file = *spill.m_pFile;
+    // Appends stay in QFile's write buffer; seek() would flush it, so only seek after a header update.
+    if ((file.pos() != spill.m_writeOffset && !file.seek(spill.m_writeOffset))
+        || file.write(sizeBytes, sizeof(sizeBytes)) != static_cast<qint64>(sizeof(sizeBytes))
+        || file.write(payload) != payload.size()) {
+        qWarning() << "Core::addTask - Cannot spill task to:" << file.fileName() << file.errorString();
+        file.resize(spill.m_writeOffset);
+        return false;
+    }
+    spill.m_writeOffset += static_cast<qint64>(sizeof(sizeBytes)) + payload.size();
+    ++spill.m_pendingRecords;
+    ++m_queuedCountByType[pTask->m_type];
+    ++m_queuedTaskCount;
+    return true;
 }
 
-inline QSharedPointer<Core::Task> Core::activeTaskByType(TaskType type) {
-    auto it = std::find_if(m_activeTaskList.begin(), m_activeTaskList.end(),
-                           [type](const auto& pTask) { return pTask->m_type == type; });
-    return (it != m_activeTaskList.end()) ? *it : QSharedPointer<Task>{};
+inline void Core::encodeSpillHeader(qint64 readOffset, uchar* pHeader) {
+    qToLittleEndian<quint32>(kSpillMagic, pHeader);
+    qToLittleEndian<quint32>(kSpillVersion, pHeader + 4);
+    qToLittleEndian<quint64>(static_cast<quint64>(readOffset), pHeader + 8);
 }
 
-inline QSharedPointer<Core::Task> Core::activeTaskByGroup(TaskGroup group) {
-    auto it = std::find_if(m_activeTaskList.begin(), m_activeTaskList.end(),
-                           [group](const auto& pTask) { return pTask->m_group == group; });
-    return (it != m_activeTaskList.end()) ? *it : QSharedPointer<Task>{};
+inline void Core::writeSpillHeader(GroupSpill& spill) {
+    uchar header[kSpillHeaderSize];
+    encodeSpillHeader(spill.m_readOffset, header);
+    QFile& file = *spill.m_pFile;
+    if (!file.seek(0) || file.write(reinterpret_cast<const char*>(header), kSpillHeaderSize) != kSpillHeaderSize || !file.flush()) {
+        qWarning() << "Core::setGroupQueueSpill - Cannot update spill file:" << file.fileName() << file.errorString();
+    }
 }
 
-inline void Core::terminateTask(QSharedPointer<Core::Task> pTask) {
-    // Set stop flag to request cooperative cancellation
-    pTask->m_stopFlag.store(true);
-
-    if (pTask->m_state == TaskState::Active) {
-        pTask->m_state = TaskState::StopRequested;
-        emit stopRequestedTask(pTask->m_id, pTask->m_type, pTask->m_argsList);
+// Maps the unread part of the file, hands up to maxRecords records to visit in order and persists the
+// new read offset. visit must not change m_groupSpills.
+template <typename F>
+void Core::readSpillRecords(GroupSpill& spill, qint64 maxRecords, F&& visit) {
+    if (spill.m_pendingRecords == 0 || maxRecords <= 0) {
+        return;
     }
-
-    // Determine timeout from task's registered stop timeout (verification window).
-    TaskStopTimeout timeout = kDefaultStopTimeout;
-    auto taskInfoIt = m_taskHash.constFind(pTask->m_type);
-    if (taskInfoIt != m_taskHash.cend()) {
-        timeout = taskInfoIt.value().m_stopTimeout;
+    QFile& file = *spill.m_pFile;
+    file.flush();
+    const qint64 unreadSize = spill.m_writeOffset - spill.m_readOffset;
+    uchar* pData = file.map(spill.m_readOffset, unreadSize);
+    if (pData == nullptr) {
+        qWarning() << "Core::setGroupQueueSpill - Cannot map spill file:" << file.fileName() << file.errorString();
+        return;
     }
 
-    // IMPORTANT: do not block the UI thread here.
-    // Request termination first, then confirm termination asynchronously.
-    bool terminationRequested = false;
+    qint64 offset = 0;
+    qint64 recordCount = 0;
+    while (recordCount < maxRecords && offset + 4 <= unreadSize) {
+        const qint64 payloadSize = qFromLittleEndian<quint32>(pData + offset);
+        const QByteArray payload = QByteArray::fromRawData(reinterpret_cast<const char*>(pData + offset + 4), static_cast<int>(payloadSize));
+        QDataStream stream(payload);
+        stream.setVersion(QDataStream::Qt_5_12);
+        SpillRecord record;
+        qint64 id = 0;
+        qint32 type = 0;
+        qint32 priority = kDefaultTaskPriority;
+        stream >> id >> type >> priority >> record.m_admittedUs >> record.m_argsList;
+        record.m_id = static_cast<TaskId>(id);
+        record.m_type = type;
+        record.m_priority = priority;
+        record.m_resumed = spill.m_readOffset + offset < spill.m_resumedEnd;
+        offset += 4 + payloadSize;
+        ++recordCount;
+        visit(std::move(record), stream.status() == QDataStream::Ok);
+    }
+    file.unmap(pData);
+
+    spill.m_readOffset += offset;
+    spill.m_pendingRecords -= recordCount;
+    // A drained file shrinks back to its header, so disk use follows the backlog too. One that never
+    // drains is rewritten once its consumed prefix is large and at least as big as the unread rest,
+    // which keeps the copying amortized to one pass per consumed byte.
+    if (spill.m_pendingRecords == 0) {
+        file.resize(kSpillHeaderSize);
+        spill.m_readOffset = kSpillHeaderSize;
+        spill.m_writeOffset = kSpillHeaderSize;
+        spill.m_resumedEnd = kSpillHeaderSize;
+    }
+    writeSpillHeader(spill);
+    const qint64 consumedSize = spill.m_readOffset - kSpillHeaderSize;
+    if (consumedSize >= kSpillCompactBytes && consumedSize >= spill.m_writeOffset - spill.m_readOffset) {
+        compactSpillFile(spill);
+    }
+}
 
-#ifdef Q_OS_WIN
-    if (pTask->m_threadHandle) {
-        if (WaitForSingleObject(pTask->m_threadHandle, 0) != WAIT_OBJECT_0) {
-            terminationRequested = (TerminateThread(pTask->m_threadHandle, 1) != 0);
-        } else {
-            // Thread already exited, but finishedTask might never be emitted (e.g. forceful exit path).
-            pTask->m_state = TaskState::Terminated;
-            CloseHandle(pTask->m_threadHandle);
-            pTask->m_threadHandle = nullptr;
-            emit terminatedTask(pTask->m_id, pTask->m_type, pTask->m_argsList);
-            m_activeTaskList.removeAll(pTask);
-            startQueuedTask();
-            return;
-        }
-    } else {
-        return; // no valid handle
+// Writes the unread records to a fresh file that QSaveFile renames over the old one, so a crash leaves
+// either file intact. The old file is closed for the rename and reopened if it failed.
+inline void Core::compactSpillFile(GroupSpill& spill) {
+    QFile& file = *spill.m_pFile;
+    const QString filePath = file.fileName();
+    const qint64 unreadSize = spill.m_writeOffset - spill.m_readOffset;
+    uchar* pData = file.map(spill.m_readOffset, unreadSize);
+    if (pData == nullptr) {
+        return; // tried again after the next read
     }
-#else
-    if (pTask->m_threadHandle != 0) {
-        if (!pTask->m_threadExited.load()) {
-            terminationRequested = (pthread_cancel(pTask->m_threadHandle) == 0);
-        } else {
-            // Thread already not alive, but finishedTask might never be emitted (e.g. pthread_exit/cancel path).
-            pTask->m_state = TaskState::Terminated;
-            emit terminatedTask(pTask->m_id, pTask->m_type, pTask->m_argsList);
-            m_activeTaskList.removeAll(pTask);
-            startQueuedTask();
-            return;
-        }
+    uchar header[kSpillHeaderSize];
+    encodeSpillHeader(kSpillHeaderSize, header);
+    QSaveFile compactedFile(filePath);
+    const bool written = compactedFile.open(QIODevice::WriteOnly)
+                         && compactedFile.write(reinterpret_cast<const char*>(header), kSpillHeaderSize) == kSpillHeaderSize
+                         && compactedFile.write(reinterpret_cast<const char*>(pData), unreadSize) == unreadSize;
+    file.unmap(pData);
+    if (!written) {
+        qWarning() << "Core::setGroupQueueSpill - Cannot compact spill file:" << filePath << compactedFile.errorString();
+        compactedFile.cancelWriting();
+        return;
+    }
+    file.close();
+    if (compactedFile.commit()) {
+        const qint64 shift = spill.m_readOffset - kSpillHeaderSize;
+        spill.m_readOffset = kSpillHeaderSize;
+        spill.m_writeOffset -= shift;
+        spill.m_resumedEnd = std::max(kSpillHeaderSize, spill.m_resumedEnd - shift);
     } else {
-        return; // no valid handle
+        qWarning() << "Core::setGroupQueueSpill - Cannot compact spill file:" << filePath << compactedFile.errorString();
     }
-#endif
-
-    if (!terminationRequested) {
-        pTask->m_state = TaskState::StopTimedOut;
-        qWarning() << QString("Task %1 terminate request was rejected by platform API").arg(QString::number(pTask->m_id));
-        emit stopTimedOutTask(pTask->m_id, pTask->m_type, pTask->m_argsList, timeout);
+    auto pFile = QSharedPointer<QFile>::create(filePath);
+    if (!pFile->open(QIODevice::ReadWrite)) {
+        // The group keeps the closed file, so spillTask and the reads fail and warn from here on.
+        qWarning() << "Core::setGroupQueueSpill - Cannot reopen spill file:" << filePath << pFile->errorString();
         return;
     }
+    spill.m_pFile = pFile;
+}
 
-    auto started = QSharedPointer<QElapsedTimer>::create();
-    started->start();
-    auto checker = QSharedPointer<std::function<void()>>::create();
-
-    *checker = [this, pTask, timeout, started, checker]() {
-        if (pTask->m_state == TaskState::Inactive
-            || pTask->m_state == TaskState::Finished
-            || pTask->m_state == TaskState::Terminated) {
-            return; // already finished/terminated by another path
-        }
-
-        bool isAlive = false;
-#ifdef Q_OS_WIN
-        if (pTask->m_threadHandle) {
-            const DWORD waitResult = WaitForSingleObject(pTask->m_threadHandle, 0);
-            isAlive = (waitResult == WAIT_TIMEOUT);
-            if (!isAlive) {
-                CloseHandle(pTask->m_threadHandle);
-                pTask->m_threadHandle = nullptr;
-            }
-        }
-#else
-        if (pTask->m_threadHandle != 0) {
-            isAlive = !pTask->m_threadExited.load();
-        }
-#endif
-
-        if (!isAlive) {
-            pTask->m_state = TaskState::Terminated;
-            emit terminatedTask(pTask->m_id, pTask->m_type, pTask->m_argsList);
-            m_activeTaskList.removeAll(pTask);
-            startQueuedTask();
-            return;
-        }
-
-        if (started->elapsed() >= timeout) {
-            pTask->m_state = TaskState::StopTimedOut;
-            qWarning() << QString("Task %1 did not stop after terminate request within timeout (%2 ms)")
-                              .arg(QString::number(pTask->m_id)).arg(timeout);
-            emit stopTimedOutTask(pTask->m_id, pTask->m_type, pTask->m_argsList, timeout);
-            return;
+// Records from an earlier process get fresh ids; pRunnable == nullptr skips rebuilding the call.
+inline QSharedPointer<Core::Task> Core::restoreSpilledTask(TaskGroup group, SpillRecord record, bool decoded, bool* pRunnable) {
+    std::function<QVariant()> function;
+    if (pRunnable != nullptr && decoded) {
+        auto taskInfoIt = m_taskHash.constFind(record.m_type);
+        if (taskInfoIt != m_taskHash.cend() && taskInfoIt.value().m_group == group && taskInfoIt.value().m_restoreFunction) {
+            function = taskInfoIt.value().m_restoreFunction(record.m_argsList);
         }
+        *pRunnable = static_cast<bool>(function);
+    }
+    if (!function) {
+        function = []() { return QVariant(); };
+    }
 
-        QTimer::singleShot(20, this, [checker]() {
-            (*checker)();
-        });
-    };
-
-    QTimer::singleShot(0, this, [checker]() {
-        (*checker)();
-    });
+    auto pTask = createTask(std::move(function), record.m_resumed ? reserveTaskIds(1) : record.m_id,
+                            record.m_type, group, std::move(record.m_argsList));
+    pTask->m_priority = record.m_priority;
+    // A record of this process keeps its admission time; one from an earlier process is added anew.
+    recordTaskAdmitted(*pTask, record.m_resumed ? 0 : record.m_admittedUs, record.m_resumed);
+    return pTask;
 }
 
-inline void Core::stopTask(QSharedPointer<Core::Task> pTask) {
-    pTask->m_stopFlag.store(true);
-    if (pTask->m_state == TaskState::Active) {
-        pTask->m_state = TaskState::StopRequested;
-        emit stopRequestedTask(pTask->m_id, pTask->m_type, pTask->m_argsList);
+// Reads spilled tasks back once the in-memory queue has half drained, so one mapping serves many tasks.
+inline void Core::refillSpilledTasks(TaskGroup group, bool drainAll) {
+    if (m_groupSpills.isEmpty()) {
+        return;
     }
-
-    TaskStopTimeout timeout = kDefaultStopTimeout;
-    auto taskInfoIt = m_taskHash.constFind(pTask->m_type);
-    if (taskInfoIt != m_taskHash.cend()) {
-        timeout = taskInfoIt.value().m_stopTimeout;
-    } else {
-        qWarning() << "Core::stopTask - Missing registration for active task type:" << pTask->m_type;
+    auto spillIt = m_groupSpills.find(group);
+    if (spillIt == m_groupSpills.end() || spillIt.value().m_pendingRecords == 0) {
+        return;
+    }
+    GroupSpill& spill = spillIt.value();
+    auto queueIt = m_queuedTasksByGroup.constFind(group);
+    const int inMemoryTasks = (queueIt != m_queuedTasksByGroup.cend()) ? queueIt.value().size() : 0;
+    if (!drainAll && inMemoryTasks > spill.m_maxInMemoryTasks / 2) {
+        return;
     }
 
-    QTimer::singleShot(timeout, this, [this, pTask, timeout]() {
-        switch (pTask->m_state) {
-        case TaskState::Finished:
-            qDebug() << QString("Task %1 was successfully stopped").arg(QString::number(pTask->m_id));
-            break;
-        case TaskState::Terminated:
-            qDebug() << QString("Task %1 was terminated").arg(QString::number(pTask->m_id));
-            break;
-        case TaskState::StopTimedOut:
-            qDebug() << QString("Task %1 stop already timed out").arg(QString::number(pTask->m_id));
-            break;
-        case TaskState::StopRequested:
-        case TaskState::Active:
-            if (!m_allowForceTermination) {
-                pTask->m_state = TaskState::StopTimedOut;
-                qWarning() << QString("Task %1 stop timed out; force termination is disabled").arg(QString::number(pTask->m_id));
-                emit stopTimedOutTask(pTask->m_id, pTask->m_type, pTask->m_argsList, timeout);
-                break;
-            }
-            qDebug() << QString("Task %1 was not stopped, terminating").arg(QString::number(pTask->m_id));
-            terminateTask(pTask);
-            if (pTask->m_state == TaskState::Active || pTask->m_state == TaskState::StopRequested) {
-                qDebug() << QString("Task %1 terminate request is in progress")
-                                .arg(QString::number(pTask->m_id));
-            }
-            break;
-        default:
-            qDebug() << QString("Task %1 unexpected state").arg(QString::number(pTask->m_id));
-            break;
+    QList<QSharedPointer<Task>> unrestorableTasks;
+    readSpillRecords(spill, drainAll ? spill.m_pendingRecords : spill.m_maxInMemoryTasks - inMemoryTasks,
+                     [this, group, &unrestorableTasks](SpillRecord&& record, bool decoded) {
+        bool runnable = false;
+        QSharedPointer<Task> pTask = restoreSpilledTask(group, std::move(record), decoded, &runnable);
+        releaseQueuedTask(pTask);
+        if (runnable) {
+            insertQueuedTask(std::move(pTask));
+        } else {
+            unrestorableTasks.append(std::move(pTask));
         }
     });
-}
-
-inline void Core::startTask(QSharedPointer<Core::Task> pTask) {
-    m_activeTaskList.append(pTask);
-    pTask->m_state = TaskState::Active;
-    pTask->m_threadExited.store(false);
-    TaskHelper* pTaskHelper = new TaskHelper(pTask->m_functionBound, &pTask->m_stopFlag, &pTask->m_threadExited, this); // Add with parent!
-
-    connect(pTaskHelper, &TaskHelper::finished, this, [this, pTask, pTaskHelper](QVariant result) {
-        pTask->m_state = TaskState::Finished;
-        emit finishedTask(pTask->m_id, pTask->m_type, pTask->m_argsList, result);
-        m_activeTaskList.removeAll(pTask);
-        startQueuedTask();
-        pTaskHelper->deleteLater();
-    });
-
-#ifdef Q_OS_WIN
-    pTask->m_threadHandle = CreateThread(nullptr, 0, &TaskHelper::functionWrapper, pTaskHelper, 0, &pTask->m_threadId);
-    if (pTask->m_threadHandle == NULL) {
-        qWarning() << "Core::startTask - Failed to create thread for task ID:" << pTask->m_id << ". GetLastError:" << GetLastError();
-        m_activeTaskList.removeAll(pTask);
-        // emit taskCreationFailed(...);
-        startQueuedTask();
-        pTaskHelper->deleteLater();
-        return; // Abort StartTask execution
+    for (const auto& pTask : std::as_const(unrestorableTasks)) {
+        qWarning() << "Core - Cannot restore spilled task" << pTask->m_id << "of type:" << pTask->m_type;
+        reportDroppedTask(pTask);
     }
-    // If everything is OK, continue...
-#else
-    // Checking pthread_create
-    int result = pthread_create(&pTask->m_threadHandle, nullptr, &TaskHelper::functionWrapper, pTaskHelper);
-    if (result != 0) {
-        qWarning() << "Core::startTask - Failed to create thread for task ID:" << pTask->m_id << ". Error code:" << result;
-        m_activeTaskList.removeAll(pTask);
-        // emit taskCreationFailed(...);
-        startQueuedTask();
-        pTaskHelper->deleteLater();
-        return; // Abort StartTask execution
-    }
-    // If everything is OK, continue...
-    pthread_detach(pTask->m_threadHandle);
-#endif
-
-    emit startedTask(pTask->m_id, pTask->m_type, pTask->m_argsList);
 }
 
-inline void Core::startQueuedTask() {
-    if (m_blockStartTask.load()) {
-        return;
-    }
-
-    for (auto it = m_queuedTaskList.begin(); it != m_queuedTaskList.end();) {
-        QSharedPointer<Task> pQueuedTask = *it;
-        bool canStart = std::none_of(std::as_const(m_activeTaskList).begin(), std::as_const(m_activeTaskList).end(),
-                                     [&pQueuedTask](const QSharedPointer<Task>& pActiveTask) {
-            return pActiveTask->m_group == pQueuedTask->m_group;
+// Reports spilled tasks as dropped in batches, so a huge backlog is never held in memory at once.
+inline void Core::discardSpilledTasks(TaskGroup group) {
+    constexpr qint64 kDiscardBatch = 1024;
+    while (true) {
+        auto spillIt = m_groupSpills.find(group);
+        if (spillIt == m_groupSpills.end() || spillIt.value().m_pendingRecords == 0) {
+            return;
+        }
+        const qint64 pendingBefore = spillIt.value().m_pendingRecords;
+        QList<QSharedPointer<Task>> droppedTasks;
+        readSpillRecords(spillIt.value(), kDiscardBatch, [this, group, &droppedTasks](SpillRecord&& record, bool decoded) {
+            QSharedPointer<Task> pTask = restoreSpilledTask(group, std::move(record), decoded, nullptr);
+            releaseQueuedTask(pTask);
+            droppedTasks.append(std::move(pTask));
         });
-        if (canStart) {
-            it = m_queuedTaskList.erase(it);
-            startTask(std::move(pQueuedTask));
-        } else {
-            ++it;
+        if (droppedTasks.isEmpty() && spillIt.value().m_pendingRecords == pendingBefore) {
+            return; // the file could not be read; the records stay for a later attempt
+        }
+        for (const auto& pTask : std::as_const(droppedTasks)) {
+            reportDroppedTask(pTask);
         }
     }
 }
 
 template <typename... Args>
-void Core::insertToTaskHash(TaskType taskType, std::function<QVariant(Args...)> taskFunction, TaskGroup taskGroup, TaskStopTimeout taskStopTimeout) {
+void Core::insertToTaskHash(TaskType taskType, std::function<QVariant(Args...)> taskFunction, TaskGroup taskGroup, TaskStopTimeout taskStopTimeout, std::any typedFunction) {
     if (m_taskHash.contains(taskType)) {
         qWarning() << "Core::registerTask - Task type is already registered:" << taskType;
         throw std::logic_error("Task type is already registered");
@@ -1036,7 +5640,36 @@ void Core::insertToTaskHash(TaskType taskType, std::function<QVariant(Args...)>
         normalizedStopTimeout = kDefaultStopTimeout;
     }
 
-    m_taskHash.insert(taskType, TaskInfo{taskFunction, taskGroup, normalizedStopTimeout});
+    auto pFunction = TaskFunctionPtr<Args...>::create(std::move(taskFunction));
+    TaskInfo taskInfo{pFunction, std::move(typedFunction), taskGroup, normalizedStopTimeout};
+    taskInfo.m_argCount = static_cast<int>(sizeof...(Args));
+    if constexpr (all_convertible_to<QVariant>::check<Args...>()) {
+        taskInfo.m_restoreFunction = [pFunction](const QList<QVariant>& argsList) {
+            return bindSpilledArgs(pFunction, argsList, std::index_sequence_for<Args...>());
+        };
+    }
+    m_taskHash.insert(taskType, std::move(taskInfo));
+}
+
+template <typename... Args, std::size_t... Indexes>
+std::function<QVariant()> Core::bindSpilledArgs(const TaskFunctionPtr<Args...>& pFunction, const QList<QVariant>& argsList,
+                                                std::index_sequence<Indexes...>) {
+    if (argsList.size() != static_cast<int>(sizeof...(Args)) || !(argsList.at(Indexes).template canConvert<Args>() && ...)) {
+        return {};
+    }
+    return [pFunction, boundArgs = std::tuple<Args...>(qvariant_cast<Args>(argsList.at(Indexes))...)]() mutable {
+        return std::apply(*pFunction, std::move(boundArgs));
+    };
+}
+
+template <typename F>
+QSharedPointer<Core::Task> Core::createTask(F&& function, TaskId id, TaskType type, TaskGroup group, QList<QVariant> argsList) {
+    // QSharedPointer::create places the control block, the task record and the callable in one allocation.
+    return QSharedPointer<BoundTask<std::decay_t<F>>>::create(std::forward<F>(function), id, type, group, std::move(argsList));
+}
+
+inline TaskId Core::reserveTaskIds(TaskId count) {
+    return s_nextTaskId.fetch_add(count);
 }
 
 #endif // CORE_H
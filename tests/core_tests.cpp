@@ -1,11 +1,30 @@
 #include <QtTest/QtTest>
 #include <QSignalSpy>
 #include <QThread>
+#include <QDeadlineTimer>
 #include <QElapsedTimer>
+#include <QTemporaryDir>
 #include <atomic>
+#include <mutex>
+#include <vector>
+#include <QSet>
 
 #include "../core.h"
 
+namespace {
+int scaleStaticTask(int value, double factor) {
+    return static_cast<int>(value * factor);
+}
+
+void countStaticTask(std::atomic_int* pCounter) {
+    pCounter->fetch_add(1);
+}
+
+using ScaleTask = StaticTask<171, &scaleStaticTask>;
+using CountTask = StaticTask<172, &countStaticTask, 172>;
+static_assert(!core_detail::hasUniqueStaticTaskTypes<ScaleTask, StaticTask<171, &countStaticTask>>());
+} // namespace
+
 class CoreTests final : public QObject {
     Q_OBJECT
 
@@ -24,6 +43,40 @@ private slots:
     void destroyingCoreRequestsStopAndWaitsForActiveTask();
     void terminateTaskByIdWhenForceDisabledRequestsCooperativeStopOnly();
     void terminateTaskByIdForceStopsNonCooperativeTask();
+    void workerPoolReusesThreadsAndSerializesGroups();
+    void setExecutionModeRejectedWhileTasksActive();
+    void workerPoolIdleWorkerStealsFromBusyWorker();
+    void statusQueriesTrackActiveAndQueuedTasks();
+    void groupQueuesKeepFifoOrderAndProgressIndependently();
+    void groupConcurrencyLimitsActiveTasksPerGroup();
+    void addTaskMovesArgumentsIntoTask();
+    void argsCaptureCanBeLazyOrDisabledPerType();
+    void taskHelpersAreReusedAcrossTasks();
+    void addTasksSubmitsBatchWithContiguousIds();
+    void batchedResultDeliveryCoalescesFinishedSignals();
+    void concurrentStopsShareSingleDeadlineTimer();
+    void shutdownStopsTasksAndReportsCompletion();
+    void shutdownReportsDeadlineWithStubbornTask();
+    void queuedTasksStartByPriorityWithAging();
+    void taskHandleDeliversTypedResultOrCancellation();
+    void dependentTasksRunAfterDependenciesAndCancelDownstream();
+    void pipelineStagesStreamThroughBoundedChannels();
+    void parallelTaskReducesChunksAndStopsTogether();
+    void postTaskSubmitsAndCancelsFromTaskThreads();
+    void schedulerThreadKeepsQueueMovingWhileOwnerIsBusy();
+    void resultCachingDeduplicatesAndMemoizesByArguments();
+    void metricsSnapshotCountsTasksAndLatencies();
+    void metricsCountPooledTasksWhenTheyRun();
+    void metricsCountBatchedTasks();
+    void chromeTraceJsonRecordsQueueWaitsAndRuns();
+    void deadlinesExpireQueuedTasksAndStopRunningOnes();
+    void groupThreadPolicyAppliesToDedicatedThreadsAndGroupWorkers();
+    void cancellationTokenStopsWholeSubtree();
+    void adaptivePoolCompensatesBlockedWorkersAndRetiresIdleOnes();
+    void staticTasksDispatchDirectlyAndShareTheRuntimeRegistry();
+    void groupRateLimitHoldsTasksInTheQueue();
+    void groupQueueSpillKeepsOverflowOnDiskAndResumesIt();
+    void stopAllTasksDropsSpilledBacklog();
 };
 
 void CoreTests::executesRegisteredTaskAndEmitsFinished() {
@@ -548,6 +601,1338 @@ void CoreTests::terminateTaskByIdForceStopsNonCooperativeTask() {
     QVERIFY(core.isIdle());
 }
 
+void CoreTests::workerPoolReusesThreadsAndSerializesGroups() {
+    Core core;
+    QVERIFY(core.setExecutionMode(Core::ExecutionMode::WorkerPool, 2));
+    QCOMPARE(core.executionMode(), Core::ExecutionMode::WorkerPool);
+    QCOMPARE(core.workerCount(), 2);
+
+    std::mutex threadsMutex;
+    QSet<Qt::HANDLE> threads;
+    std::atomic_int inGroup{0};
+    std::atomic_int maxInGroup{0};
+
+    auto pooledTask = [&](int tag) -> int {
+        const int now = ++inGroup;
+        int observedMax = maxInGroup.load();
+        while (now > observedMax && !maxInGroup.compare_exchange_weak(observedMax, now)) {
+        }
+        {
+            std::lock_guard<std::mutex> lock(threadsMutex);
+            threads.insert(QThread::currentThreadId());
+        }
+        QThread::msleep(5);
+        --inGroup;
+        return tag;
+    };
+    core.registerTask(90, pooledTask, 90);
+    core.registerTask(91, [](int tag) -> int { return tag; }, 91);
+
+    QSignalSpy startedSpy(&core, &Core::startedTask);
+    QSignalSpy finishedSpy(&core, &Core::finishedTask);
+    QVERIFY(startedSpy.isValid());
+    QVERIFY(finishedSpy.isValid());
+
+    for (int i = 0; i < 10; ++i) {
+        core.addTask(90, i);
+        core.addTask(91, i);
+    }
+
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 20, 5000);
+    QCOMPARE(startedSpy.count(), 20);
+    QCOMPARE(maxInGroup.load(), 1);
+    QVERIFY(threads.size() <= 2);
+    QVERIFY(core.isIdle());
+}
+
+void CoreTests::setExecutionModeRejectedWhileTasksActive() {
+    Core core;
+
+    core.registerTask(92, [&core]() -> int {
+        for (int i = 0; i < 500; ++i) {
+            if (auto* stop = core.stopTaskFlag(); stop && stop->load()) {
+                return -92;
+            }
+            QThread::msleep(2);
+        }
+        return 92;
+    }, 92, 150);
+
+    QSignalSpy finishedSpy(&core, &Core::finishedTask);
+    QVERIFY(finishedSpy.isValid());
+
+    core.addTask(92);
+    QVERIFY(!core.setExecutionMode(Core::ExecutionMode::WorkerPool, 2));
+    QCOMPARE(core.executionMode(), Core::ExecutionMode::DedicatedThreads);
+
+    core.cancelAllTasks();
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 1, 5000);
+    QVERIFY(core.setExecutionMode(Core::ExecutionMode::WorkerPool, 2));
+}
+
+void CoreTests::workerPoolIdleWorkerStealsFromBusyWorker() {
+    Core core;
+    QVERIFY(core.setExecutionMode(Core::ExecutionMode::WorkerPool, 2));
+
+    core.registerTask(93, [&core]() -> int {
+        for (int i = 0; i < 1000; ++i) {
+            if (auto* stop = core.stopTaskFlag(); stop && stop->load()) {
+                return -93;
+            }
+            QThread::msleep(2);
+        }
+        return 93;
+    }, 93, 200);
+
+    std::atomic_int quickFinished{0};
+    for (int i = 0; i < 6; ++i) {
+        core.registerTask(100 + i, [&quickFinished]() -> int {
+            QThread::msleep(5);
+            return ++quickFinished;
+        }, 100 + i);
+    }
+
+    QSignalSpy finishedSpy(&core, &Core::finishedTask);
+    QVERIFY(finishedSpy.isValid());
+
+    // Round-robin submission places half of the quick tasks behind the blocking one.
+    core.addTask(93);
+    for (int i = 0; i < 6; ++i) {
+        core.addTask(100 + i);
+    }
+
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 6, 1000);
+    QCOMPARE(quickFinished.load(), 6);
+    bool isActive = false;
+    QVERIFY(core.isTaskAddedByType(93, &isActive));
+    QVERIFY(isActive);
+
+    core.cancelAllTasks();
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 7, 5000);
+}
+
+void CoreTests::statusQueriesTrackActiveAndQueuedTasks() {
+    Core core;
+
+    core.registerTask(110, [&core]() -> int {
+        for (int i = 0; i < 500; ++i) {
+            if (auto* stop = core.stopTaskFlag(); stop && stop->load()) {
+                return -110;
+            }
+            QThread::msleep(2);
+        }
+        return 110;
+    }, 11, 150);
+    core.registerTask(111, [](int tag) -> int { return tag; }, 11);
+
+    QSignalSpy finishedSpy(&core, &Core::finishedTask);
+    QVERIFY(finishedSpy.isValid());
+
+    core.addTask(110);
+    for (int i = 0; i < 1000; ++i) {
+        core.addTask(111, i);
+    }
+
+    bool isActive = false;
+    QVERIFY(core.isTaskAddedByType(110, &isActive));
+    QVERIFY(isActive);
+    QVERIFY(core.isTaskAddedByType(111, &isActive));
+    QVERIFY(!isActive);
+    QVERIFY(core.isTaskAddedByGroup(11, &isActive));
+    QVERIFY(isActive);
+    QVERIFY(!core.isTaskAddedByGroup(12, &isActive));
+    QVERIFY(!core.unregisterTask(111));
+
+    core.cancelTaskByType(110);
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 1001, 10000);
+
+    QVERIFY(!core.isTaskAddedByType(110));
+    QVERIFY(!core.isTaskAddedByType(111));
+    QVERIFY(!core.isTaskAddedByGroup(11));
+    QVERIFY(core.isIdle());
+    QVERIFY(core.unregisterTask(111));
+}
+
+void CoreTests::groupQueuesKeepFifoOrderAndProgressIndependently() {
+    Core core;
+
+    core.registerTask(120, [](int tag) -> int {
+        QThread::msleep(10);
+        return tag;
+    }, 12);
+    core.registerTask(121, [](int tag) -> int {
+        QThread::msleep(2);
+        return tag;
+    }, 13);
+
+    QList<int> group12Order;
+    QList<int> group13Order;
+    QObject::connect(&core, &Core::finishedTask, &core, [&](TaskId, TaskType type, const QVariantList&, const QVariant& result) {
+        (type == 120 ? group12Order : group13Order).append(result.toInt());
+    });
+
+    for (int i = 0; i < 5; ++i) {
+        core.addTask(120, i);
+    }
+    for (int i = 0; i < 5; ++i) {
+        core.addTask(121, 100 + i);
+    }
+
+    // Group 13 drains while group 12 is still working through its own queue.
+    QTRY_COMPARE_WITH_TIMEOUT(group13Order.size(), 5, 2000);
+    QVERIFY(group12Order.size() < 5);
+    QTRY_COMPARE_WITH_TIMEOUT(group12Order.size(), 5, 2000);
+
+    QCOMPARE(group12Order, QList<int>({0, 1, 2, 3, 4}));
+    QCOMPARE(group13Order, QList<int>({100, 101, 102, 103, 104}));
+}
+
+void CoreTests::groupConcurrencyLimitsActiveTasksPerGroup() {
+    Core core;
+    QCOMPARE(core.groupConcurrency(14), kDefaultGroupConcurrency);
+    core.setGroupConcurrency(14, 3);
+    core.setGroupConcurrency(0, kUnlimitedGroupConcurrency);
+    QCOMPARE(core.groupConcurrency(14), 3);
+    QCOMPARE(core.groupConcurrency(0), kUnlimitedGroupConcurrency);
+
+    std::atomic_int inGroup14{0};
+    std::atomic_int maxInGroup14{0};
+    std::atomic_int inGroup0{0};
+    std::atomic_int maxInGroup0{0};
+    auto trackingTask = [](std::atomic_int& current, std::atomic_int& maximum) {
+        const int now = ++current;
+        int observedMax = maximum.load();
+        while (now > observedMax && !maximum.compare_exchange_weak(observedMax, now)) {
+        }
+        QThread::msleep(60);
+        --current;
+    };
+
+    core.registerTask(130, [&]() -> int {
+        trackingTask(inGroup14, maxInGroup14);
+        return 130;
+    }, 14);
+    core.registerTask(131, [&]() -> int {
+        trackingTask(inGroup0, maxInGroup0);
+        return 131;
+    });
+
+    QSignalSpy finishedSpy(&core, &Core::finishedTask);
+    QVERIFY(finishedSpy.isValid());
+
+    for (int i = 0; i < 6; ++i) {
+        core.addTask(130);
+    }
+    for (int i = 0; i < 4; ++i) {
+        core.addTask(131);
+    }
+
+    bool isActive = false;
+    QVERIFY(core.isTaskAddedByGroup(14, &isActive));
+    QVERIFY(isActive);
+    QVERIFY(core.isTaskAddedByType(130, &isActive));
+
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 10, 5000);
+    QCOMPARE(maxInGroup14.load(), 3);
+    QCOMPARE(maxInGroup0.load(), 4);
+}
+
+void CoreTests::addTaskMovesArgumentsIntoTask() {
+    Core core;
+
+    std::atomic<const int*> receivedData{nullptr};
+    core.registerTask(140, [&receivedData](std::vector<int> payload, const QString& label) -> int {
+        receivedData.store(payload.data());
+        return static_cast<int>(payload.size()) + label.size();
+    });
+
+    QSignalSpy finishedSpy(&core, &Core::finishedTask);
+    QVERIFY(finishedSpy.isValid());
+
+    std::vector<int> payload(4096, 7);
+    const int* originalData = payload.data();
+    const QString label(QStringLiteral("abc"));
+    core.addTask(140, std::move(payload), label);
+
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 1, 2000);
+    QCOMPARE(finishedSpy.takeFirst().at(3).toInt(), 4096 + 3);
+    // The buffer travelled through the task without being deep-copied.
+    QCOMPARE(receivedData.load(), originalData);
+
+    bool thrown = false;
+    try {
+        core.addTask(140, 1, 2);
+    } catch (const std::logic_error&) {
+        thrown = true;
+    }
+    QVERIFY(thrown);
+}
+
+void CoreTests::argsCaptureCanBeLazyOrDisabledPerType() {
+    Core core;
+
+    core.registerTask(141, [](int value) -> int { return value * 2; });
+    QCOMPARE(core.taskArgsCapture(141), Core::ArgsCapture::Eager);
+    QVERIFY(!core.setTaskArgsCapture(142, Core::ArgsCapture::Disabled));
+
+    QSignalSpy finishedSpy(&core, &Core::finishedTask);
+    QVERIFY(finishedSpy.isValid());
+
+    QVERIFY(core.setTaskArgsCapture(141, Core::ArgsCapture::Disabled));
+    QCOMPARE(core.taskArgsCapture(141), Core::ArgsCapture::Disabled);
+    core.addTask(141, 21);
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 1, 2000);
+    QList<QVariant> arguments = finishedSpy.takeFirst();
+    QVERIFY(arguments.at(2).toList().isEmpty());
+    QCOMPARE(arguments.at(3).toInt(), 42);
+
+    // Lazy capture still fills argsList while a receiver (the spy) is connected.
+    QVERIFY(core.setTaskArgsCapture(141, Core::ArgsCapture::Lazy));
+    core.addTask(141, 5);
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 1, 2000);
+    arguments = finishedSpy.takeFirst();
+    QCOMPARE(arguments.at(2).toList(), QList<QVariant>({ 5 }));
+    QCOMPARE(arguments.at(3).toInt(), 10);
+
+    // A receiver of the batched results alone is enough for Lazy capture.
+    Core batchedCore;
+    batchedCore.registerTask(141, [](int value) -> int { return value * 2; });
+    QVERIFY(batchedCore.setTaskArgsCapture(141, Core::ArgsCapture::Lazy));
+    QVERIFY(batchedCore.setTaskResultDelivery(141, Core::ResultDelivery::Batched));
+    QVector<Core::TaskResult> batchedResults;
+    connect(&batchedCore, &Core::finishedTasks, this, [&batchedResults](const QVector<Core::TaskResult>& results) {
+        for (const Core::TaskResult& result : results) {
+            batchedResults.append(result);
+        }
+    });
+    batchedCore.addTask(141, 7);
+    QTRY_COMPARE_WITH_TIMEOUT(batchedResults.size(), 1, 2000);
+    QCOMPARE(batchedResults.first().argsList, QList<QVariant>({ 7 }));
+}
+
+void CoreTests::taskHelpersAreReusedAcrossTasks() {
+    Core core;
+    QVERIFY(core.setExecutionMode(Core::ExecutionMode::WorkerPool, 2));
+
+    core.registerTask(143, [](int value) -> int { return value + 1; }, 143);
+    core.setGroupConcurrency(143, 2);
+
+    QSignalSpy finishedSpy(&core, &Core::finishedTask);
+    QVERIFY(finishedSpy.isValid());
+
+    for (int round = 0; round < 5; ++round) {
+        core.addTask(143, round);
+        core.addTask(143, round);
+        QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 2 * (round + 1), 2000);
+    }
+
+    // At most two tasks ran at once, so at most two helpers were ever created.
+    const int helperCount = core.findChildren<TaskHelper*>().size();
+    QVERIFY(helperCount >= 1);
+    QVERIFY(helperCount <= 2);
+}
+
+void CoreTests::addTasksSubmitsBatchWithContiguousIds() {
+    Core core;
+
+    core.registerTask(144, [](int value, const QString& label) -> int {
+        return value + label.size();
+    }, 144);
+
+    QSignalSpy finishedSpy(&core, &Core::finishedTask);
+    QVERIFY(finishedSpy.isValid());
+
+    std::vector<std::tuple<int, QString>> batch;
+    for (int i = 0; i < 5; ++i) {
+        batch.emplace_back(i * 10, QStringLiteral("ab"));
+    }
+    const Core::TaskIdRange range = core.addTasks(144, std::move(batch));
+    QCOMPARE(range.count, TaskId(5));
+
+    // Group 144 runs one task at a time, so the rest of the batch waits in the group queue.
+    bool isActive = false;
+    QVERIFY(core.isTaskAddedByGroup(144, &isActive));
+
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 5, 2000);
+    for (int i = 0; i < 5; ++i) {
+        const QList<QVariant> arguments = finishedSpy.at(i);
+        const auto id = static_cast<TaskId>(arguments.at(0).toLongLong());
+        QVERIFY(range.contains(id));
+        QCOMPARE(id, range.first + i);
+        QCOMPARE(arguments.at(3).toInt(), i * 10 + 2);
+    }
+
+    const std::vector<std::tuple<int, QString>> emptyBatch;
+    QVERIFY(core.addTasks(144, emptyBatch).isEmpty());
+
+    bool thrown = false;
+    try {
+        core.addTasks(144, std::vector<std::tuple<int>>{ std::tuple<int>(1) });
+    } catch (const std::logic_error&) {
+        thrown = true;
+    }
+    QVERIFY(thrown);
+}
+
+void CoreTests::batchedResultDeliveryCoalescesFinishedSignals() {
+    Core core;
+    QVERIFY(core.setExecutionMode(Core::ExecutionMode::WorkerPool, 2));
+
+    core.registerTask(145, [](int value) -> int { return value * 3; }, 145);
+    core.setGroupConcurrency(145, kUnlimitedGroupConcurrency);
+    QCOMPARE(core.taskResultDelivery(145), Core::ResultDelivery::PerTask);
+    QVERIFY(core.setTaskResultDelivery(145, Core::ResultDelivery::Batched));
+    core.setResultFlushInterval(10);
+    QCOMPARE(core.resultFlushInterval(), 10);
+
+    QSignalSpy finishedSpy(&core, &Core::finishedTask);
+    QSignalSpy batchSpy(&core, &Core::finishedTasks);
+    QVERIFY(finishedSpy.isValid());
+    QVERIFY(batchSpy.isValid());
+
+    constexpr int kTaskCount = 20;
+    for (int i = 0; i < kTaskCount; ++i) {
+        core.addTask(145, i);
+    }
+
+    QMap<int, int> resultsByValue;
+    QList<TaskType> resultTypes;
+    QElapsedTimer timer;
+    timer.start();
+    while (resultsByValue.size() < kTaskCount && timer.elapsed() < 2000) {
+        if (batchSpy.isEmpty()) {
+            batchSpy.wait(50);
+            continue;
+        }
+        const auto results = batchSpy.takeFirst().at(0).value<QVector<Core::TaskResult>>();
+        for (const auto& result : results) {
+            resultTypes.append(result.type);
+            resultsByValue.insert(result.argsList.at(0).toInt(), result.result.toInt());
+        }
+    }
+
+    QCOMPARE(resultsByValue.size(), kTaskCount);
+    QVERIFY(std::all_of(resultTypes.cbegin(), resultTypes.cend(), [](TaskType type) { return type == 145; }));
+    for (int i = 0; i < kTaskCount; ++i) {
+        QCOMPARE(resultsByValue.value(i), i * 3);
+    }
+    QCOMPARE(finishedSpy.count(), 0);
+    QVERIFY(core.isIdle());
+}
+
+void CoreTests::concurrentStopsShareSingleDeadlineTimer() {
+    Core core;
+
+    // Ignores the stop flag for a while, so every stop window is still pending when checked.
+    core.registerTask(146, [](int tag) -> int {
+        QThread::msleep(300);
+        return tag;
+    }, 146, 100);
+    core.setGroupConcurrency(146, kUnlimitedGroupConcurrency);
+
+    QSignalSpy startedSpy(&core, &Core::startedTask);
+    QSignalSpy finishedSpy(&core, &Core::finishedTask);
+    QSignalSpy stopTimedOutSpy(&core, &Core::stopTimedOutTask);
+    QVERIFY(startedSpy.isValid());
+    QVERIFY(finishedSpy.isValid());
+    QVERIFY(stopTimedOutSpy.isValid());
+
+    constexpr int kTaskCount = 8;
+    for (int i = 0; i < kTaskCount; ++i) {
+        core.addTask(146, i);
+    }
+    QTRY_COMPARE_WITH_TIMEOUT(startedSpy.count(), kTaskCount, 2000);
+
+    for (const QList<QVariant>& event : std::as_const(startedSpy)) {
+        core.stopTaskById(static_cast<TaskId>(event.at(0).toLongLong()));
+    }
+    QCOMPARE(core.findChildren<QTimer*>().size(), 1);
+
+    // Force termination is disabled, so each elapsed stop window reports a timeout once.
+    QTRY_COMPARE_WITH_TIMEOUT(stopTimedOutSpy.count(), kTaskCount, 2000);
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), kTaskCount, 2000);
+    QVERIFY(core.isIdle());
+}
+
+void CoreTests::shutdownStopsTasksAndReportsCompletion() {
+    Core core;
+
+    core.registerTask(147, [&core](int tag) -> int {
+        for (int i = 0; i < 1000; ++i) {
+            if (auto* stop = core.stopTaskFlag(); stop && stop->load()) {
+                return -tag;
+            }
+            QThread::msleep(2);
+        }
+        return tag;
+    }, 147);
+
+    QSignalSpy finishedSpy(&core, &Core::finishedTask);
+    QSignalSpy terminatedSpy(&core, &Core::terminatedTask);
+    QSignalSpy shutdownSpy(&core, &Core::shutdownFinished);
+    QVERIFY(finishedSpy.isValid());
+    QVERIFY(terminatedSpy.isValid());
+    QVERIFY(shutdownSpy.isValid());
+
+    core.addTask(147, 1); // active
+    core.addTask(147, 2); // queued in the same group
+    core.shutdown(QDeadlineTimer(2000));
+    QVERIFY(core.isShuttingDown());
+
+    // The queued task never started, so it is reported as terminated right away.
+    QCOMPARE(terminatedSpy.count(), 1);
+    QTRY_COMPARE_WITH_TIMEOUT(shutdownSpy.count(), 1, 2000);
+    QCOMPARE(shutdownSpy.takeFirst().at(0).toBool(), true);
+    QCOMPARE(finishedSpy.count(), 1);
+    QCOMPARE(finishedSpy.takeFirst().at(3).toInt(), -1);
+
+    // Nothing starts after shutdown.
+    core.addTask(147, 3);
+    QTest::qWait(50);
+    QCOMPARE(finishedSpy.count(), 0);
+}
+
+void CoreTests::shutdownReportsDeadlineWithStubbornTask() {
+    Core core;
+    core.setShutdownTimeout(300);
+    QCOMPARE(core.shutdownTimeout(), 300);
+
+    core.registerTask(148, []() -> int {
+        QThread::msleep(300);
+        return 148;
+    }, 148);
+
+    QSignalSpy finishedSpy(&core, &Core::finishedTask);
+    QSignalSpy shutdownSpy(&core, &Core::shutdownFinished);
+    QVERIFY(finishedSpy.isValid());
+    QVERIFY(shutdownSpy.isValid());
+
+    core.addTask(148);
+    QElapsedTimer sinceShutdown;
+    sinceShutdown.start();
+    core.shutdown(QDeadlineTimer(50));
+
+    QTRY_COMPARE_WITH_TIMEOUT(shutdownSpy.count(), 1, 2000);
+    QCOMPARE(shutdownSpy.takeFirst().at(0).toBool(), false);
+    QVERIFY(sinceShutdown.elapsed() < 250);
+
+    // Let the stubborn task run out before the Core goes away.
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 1, 2000);
+}
+
+void CoreTests::queuedTasksStartByPriorityWithAging() {
+    Core core;
+    QCOMPARE(core.priorityAging(), kDefaultPriorityAging);
+
+    std::atomic_bool releaseBlocker{false};
+    core.registerTask(149, [&releaseBlocker]() -> int {
+        while (!releaseBlocker.load()) {
+            QThread::msleep(1);
+        }
+        return 0;
+    }, 149);
+    core.registerTask(150, [](int tag) -> int { return tag; }, 149);
+    QVERIFY(core.setTaskPriority(150, 1));
+    QCOMPARE(core.taskPriority(150), 1);
+
+    QList<int> startOrder;
+    QObject::connect(&core, &Core::startedTask, &core, [&startOrder](TaskId, TaskType type, const QVariantList& argsList) {
+        if (type == 150) {
+            startOrder.append(argsList.first().toInt());
+        }
+    });
+    QSignalSpy finishedSpy(&core, &Core::finishedTask);
+    QVERIFY(finishedSpy.isValid());
+
+    auto runRound = [&]() {
+        releaseBlocker.store(true);
+        QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 7, 2000);
+        finishedSpy.clear();
+        releaseBlocker.store(false);
+    };
+
+    // Default aging: one priority level outweighs every earlier queued task in this round.
+    core.addTask(149);
+    for (int tag = 1; tag <= 5; ++tag) {
+        core.addTaskWithPriority(150, kDefaultTaskPriority, tag);
+    }
+    core.addTask(150, 6); // type default priority 1
+    runRound();
+    QCOMPARE(startOrder, QList<int>({ 6, 1, 2, 3, 4, 5 }));
+
+    // With aging 1 a priority level is worth one position, so a priority 2 task passes only two waiters.
+    startOrder.clear();
+    core.setPriorityAging(1);
+    core.addTask(149);
+    for (int tag = 1; tag <= 5; ++tag) {
+        core.addTaskWithPriority(150, kDefaultTaskPriority, tag);
+    }
+    core.addTaskWithPriority(150, 2, 6);
+    runRound();
+    QCOMPARE(startOrder, QList<int>({ 1, 2, 3, 6, 4, 5 }));
+}
+
+void CoreTests::taskHandleDeliversTypedResultOrCancellation() {
+    Core core;
+
+    core.registerTask(151, [](const QString& text, int times) -> QString { return text.repeated(times); });
+    TaskHandle<QString> handle = core.addTaskWithHandle<QString>(151, QString("ab"), 2);
+    QVERIFY(handle.isValid());
+
+    QString continuationValue;
+    handle.then(&core, [&continuationValue](const QString& value) { continuationValue = value; });
+    QVERIFY(handle.wait(2000));
+    QVERIFY(handle.isFinished());
+    QCOMPARE(handle.result(), QString("abab"));
+    QTRY_COMPARE_WITH_TIMEOUT(continuationValue, QString("abab"), 2000);
+
+    // A handle whose task is dropped from the queue is canceled instead of left pending.
+    core.registerTask(152, [&core]() {
+        while (auto* stop = core.stopTaskFlag()) {
+            if (stop->load()) {
+                return;
+            }
+            QThread::msleep(1);
+        }
+    }, 152);
+    core.registerTask(153, [](int value) -> int { return value; }, 152);
+    core.addTask(152);
+    TaskHandle<int> queuedHandle = core.addTaskWithHandle<int>(153, 7);
+
+    bool canceledReported = false;
+    queuedHandle.onCanceled(&core, [&canceledReported]() { canceledReported = true; });
+    core.stopTasksByGroup(152, true);
+    QVERIFY(queuedHandle.isCanceled());
+    QVERIFY_EXCEPTION_THROWN(queuedHandle.result(), std::runtime_error);
+    QTRY_VERIFY_WITH_TIMEOUT(canceledReported, 2000);
+    QTRY_VERIFY_WITH_TIMEOUT(core.isIdle(), 2000);
+
+    // Parameters are registered decayed, so a plain addTask finds a function taking const T&.
+    QSignalSpy finishedSpy(&core, &Core::finishedTask);
+    QVERIFY(finishedSpy.isValid());
+    core.addTask(151, QString("c"), 3);
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 1, 2000);
+    QCOMPARE(finishedSpy.at(0).at(3).toString(), QString("ccc"));
+
+    // A continuation whose context is deleted before the task completes is dropped.
+    auto* pContext = new QObject;
+    bool lateContinuationRan = false;
+    TaskHandle<void> blockedHandle = core.addTaskWithHandle<void>(152);
+    blockedHandle.then(pContext, [&lateContinuationRan]() { lateContinuationRan = true; });
+    delete pContext;
+    core.stopTaskById(blockedHandle.id());
+    QVERIFY(blockedHandle.wait(2000));
+    QVERIFY(blockedHandle.isFinished());
+    QTest::qWait(50);
+    QVERIFY(!lateContinuationRan);
+}
+
+void CoreTests::dependentTasksRunAfterDependenciesAndCancelDownstream() {
+    Core core;
+
+    std::atomic_bool releaseBlocker{false};
+    core.registerTask(154, [](int value) -> int { return value * 10; });
+    core.registerTask(155, [&core, &releaseBlocker]() {
+        while (!releaseBlocker.load()) {
+            if (auto* stop = core.stopTaskFlag(); stop && stop->load()) {
+                return;
+            }
+            QThread::msleep(1);
+        }
+    }, 155);
+
+    TaskHandle<int> first = core.addTaskWithHandle<int>(154, 1);
+    TaskHandle<void> blocker = core.addTaskWithHandle<void>(155);
+    TaskHandle<int> joined = core.addTaskAfter<int>({ first, blocker }, 154, 3);
+
+    QTRY_VERIFY_WITH_TIMEOUT(first.isFinished(), 2000);
+    QTest::qWait(50);
+    QVERIFY(!joined.isDone());
+    releaseBlocker.store(true);
+    QTRY_VERIFY_WITH_TIMEOUT(joined.isFinished(), 2000);
+    QCOMPARE(joined.result(), 30);
+    QTRY_VERIFY_WITH_TIMEOUT(core.isIdle(), 2000);
+
+    // Cancelling a node cancels the chain that waits on it.
+    releaseBlocker.store(false);
+    QSignalSpy terminatedSpy(&core, &Core::terminatedTask);
+    QVERIFY(terminatedSpy.isValid());
+    TaskHandle<void> root = core.addTaskWithHandle<void>(155);
+    TaskHandle<int> middle = core.addTaskAfter<int>({ root }, 154, 4);
+    TaskHandle<int> leaf = core.addTaskAfter<int>({ middle }, 154, 5);
+    core.cancelTaskById(root.id());
+    QVERIFY(middle.isCanceled());
+    QVERIFY(leaf.isCanceled());
+    QCOMPARE(terminatedSpy.count(), 2);
+    QTRY_VERIFY_WITH_TIMEOUT(core.isIdle(), 2000);
+}
+
+void CoreTests::pipelineStagesStreamThroughBoundedChannels() {
+    Core core;
+
+    TaskChannel<int> numbers(3);
+    TaskChannel<int> doubled(3);
+    QCOMPARE(numbers.capacity(), 4);
+
+    std::atomic_int sum{0};
+    core.registerPipelineStage<void, int>(156, [next = 0]() mutable -> std::optional<int> {
+        if (next == 100) {
+            return std::nullopt;
+        }
+        return ++next;
+    }, 156);
+    core.registerPipelineStage<int, int>(157, [](int value) { return value * 2; }, 157);
+    core.registerPipelineStage<int, void>(158, [&sum](int value) { sum += value; }, 158);
+    core.setGroupConcurrency(157, 2);
+
+    QSignalSpy finishedSpy(&core, &Core::finishedTask);
+    QVERIFY(finishedSpy.isValid());
+
+    core.addPipelineSink(158, doubled);
+    core.addPipelineStage(157, numbers, doubled, 2);
+    core.addPipelineSource(156, numbers);
+
+    // The source ends after 100 items; closing propagates once both middle instances have drained.
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 4, 5000);
+    QCOMPARE(sum.load(), 10100);
+    QVERIFY(numbers.isClosed());
+    QVERIFY(doubled.isClosed());
+    QVERIFY(!doubled.tryPush(1));
+}
+
+void CoreTests::parallelTaskReducesChunksAndStopsTogether() {
+    Core core;
+    QVERIFY(core.setExecutionMode(Core::ExecutionMode::WorkerPool, 4));
+
+    core.registerMapReduce<qint64>(159, [](qint64 begin, qint64 end) {
+        qint64 sum = 0;
+        for (qint64 i = begin; i < end; ++i) {
+            sum += i;
+        }
+        return sum;
+    }, [](qint64 left, qint64 right) { return left + right; }, 0, 1000);
+
+    QSignalSpy finishedSpy(&core, &Core::finishedTask);
+    QVERIFY(finishedSpy.isValid());
+
+    const TaskId sumId = core.addParallelTask(159, 0, 100000);
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 1, 5000);
+    auto finished = finishedSpy.takeFirst();
+    QCOMPARE(static_cast<TaskId>(finished.at(0).toLongLong()), sumId);
+    QCOMPARE(finished.at(3).toLongLong(), qint64(4999950000LL));
+
+    // One cancelTaskById on the parent reaches the chunks running on the helpers.
+    std::atomic_int chunksDone{0};
+    core.registerParallelFor(160, [&core, &chunksDone](qint64, qint64) {
+        for (int i = 0; i < 20; ++i) {
+            if (auto* stop = core.stopTaskFlag(); stop && stop->load()) {
+                return;
+            }
+            QThread::msleep(1);
+        }
+        ++chunksDone;
+    }, 1);
+
+    const TaskId loopId = core.addParallelTask(160, 0, 1000);
+    QTRY_VERIFY_WITH_TIMEOUT(chunksDone.load() > 0, 2000);
+    core.cancelTaskById(loopId);
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 1, 2000);
+    QCOMPARE(static_cast<TaskId>(finishedSpy.takeFirst().at(0).toLongLong()), loopId);
+    QVERIFY(chunksDone.load() < 1000);
+}
+
+void CoreTests::postTaskSubmitsAndCancelsFromTaskThreads() {
+    Core core;
+
+    std::atomic_bool releaseFollowUps{false};
+    core.registerTask(162, [&releaseFollowUps](int value) -> int {
+        while (!releaseFollowUps.load()) {
+            QThread::msleep(1);
+        }
+        return value;
+    }, 162);
+
+    std::atomic<TaskId> canceledId{-1};
+    core.registerTask(161, [&core, &canceledId](int count) {
+        TaskId lastId = -1;
+        for (int i = 0; i < count; ++i) {
+            lastId = core.postTask(162, i);
+        }
+        // Still queued behind the others in group 162 when the cancellation is drained.
+        core.postCancelTaskById(lastId);
+        canceledId.store(lastId);
+    });
+
+    QSignalSpy finishedSpy(&core, &Core::finishedTask);
+    QSignalSpy terminatedSpy(&core, &Core::terminatedTask);
+    QVERIFY(finishedSpy.isValid());
+    QVERIFY(terminatedSpy.isValid());
+
+    core.addTask(161, 4);
+    QTRY_COMPARE_WITH_TIMEOUT(terminatedSpy.count(), 1, 2000);
+    QCOMPARE(static_cast<TaskId>(terminatedSpy.takeFirst().at(0).toLongLong()), canceledId.load());
+
+    releaseFollowUps.store(true);
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 4, 2000);
+    QTRY_VERIFY_WITH_TIMEOUT(core.isIdle(), 2000);
+}
+
+void CoreTests::schedulerThreadKeepsQueueMovingWhileOwnerIsBusy() {
+    std::atomic_int completed{0};
+    QList<TaskId> finishedIds;
+    bool finishedOnTestThread = true;
+    QObject receiver;
+    {
+        Core core;
+        core.registerTask(163, [&completed](int value) -> int {
+            QThread::msleep(20);
+            ++completed;
+            return value;
+        }, 163);
+        QVERIFY(core.startSchedulerThread());
+        QVERIFY(core.hasSchedulerThread());
+        QVERIFY(core.thread() != QThread::currentThread());
+
+        QObject::connect(&core, &Core::finishedTask, &receiver, [&](TaskId id, TaskType, const QVariantList&, const QVariant&) {
+            finishedIds.append(id);
+            finishedOnTestThread = finishedOnTestThread && QThread::currentThread() == receiver.thread();
+        });
+
+        QList<TaskId> postedIds;
+        for (int i = 0; i < 3; ++i) {
+            postedIds.append(core.postTask(163, i));
+        }
+
+        // The group runs one task at a time; the queue drains while this thread handles no events.
+        QThread::msleep(300);
+        QCOMPARE(completed.load(), 3);
+        QVERIFY(finishedIds.isEmpty());
+
+        QTRY_COMPARE_WITH_TIMEOUT(finishedIds, postedIds, 2000);
+    }
+    QVERIFY(finishedOnTestThread);
+}
+
+void CoreTests::resultCachingDeduplicatesAndMemoizesByArguments() {
+    Core core;
+
+    std::atomic_int runs{0};
+    core.registerTask(164, [&runs](int value) -> int {
+        ++runs;
+        QThread::msleep(50);
+        return value * value;
+    }, 164);
+    QCOMPARE(core.taskResultCaching(164), 0);
+    QVERIFY(core.setTaskResultCaching(164, 1));
+    QCOMPARE(core.taskResultCaching(164), 1);
+
+    QSignalSpy finishedSpy(&core, &Core::finishedTask);
+    QVERIFY(finishedSpy.isValid());
+
+    // The duplicate attaches to the run in flight; the third call is answered from the cache.
+    core.addTask(164, 3);
+    core.addTask(164, 3);
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 2, 2000);
+    core.addTask(164, 3);
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 3, 2000);
+    QCOMPARE(runs.load(), 1);
+    QSet<TaskId> ids;
+    for (const auto& finished : std::as_const(finishedSpy)) {
+        QCOMPARE(finished.at(3).toInt(), 9);
+        ids.insert(static_cast<TaskId>(finished.at(0).toLongLong()));
+    }
+    QCOMPARE(ids.size(), 3);
+
+    // With room for one entry, a new argument list evicts the older one.
+    core.addTask(164, 4);
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 4, 2000);
+    core.addTask(164, 3);
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 5, 2000);
+    QCOMPARE(runs.load(), 3);
+
+    // A duplicate can be canceled on its own, and stopping the run hands it to the next duplicate.
+    QSignalSpy startedSpy(&core, &Core::startedTask);
+    QSignalSpy terminatedSpy(&core, &Core::terminatedTask);
+    QVERIFY(startedSpy.isValid());
+    QVERIFY(terminatedSpy.isValid());
+    core.addTask(164, 5);
+    QCOMPARE(startedSpy.count(), 1);
+    const TaskId leaderId = static_cast<TaskId>(startedSpy.at(0).at(0).toLongLong());
+    const TaskId canceledDuplicateId = core.postTask(164, 5);
+    const TaskId nextId = core.postTask(164, 5);
+    QCoreApplication::processEvents();
+    core.cancelTaskById(canceledDuplicateId);
+    QCOMPARE(terminatedSpy.count(), 1);
+    QCOMPARE(static_cast<TaskId>(terminatedSpy.at(0).at(0).toLongLong()), canceledDuplicateId);
+
+    core.cancelTaskById(leaderId);
+    QTRY_COMPARE_WITH_TIMEOUT(startedSpy.count(), 2, 2000);
+    QCOMPARE(static_cast<TaskId>(startedSpy.at(1).at(0).toLongLong()), nextId);
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 7, 2000);
+    QCOMPARE(static_cast<TaskId>(finishedSpy.at(6).at(0).toLongLong()), nextId);
+    QCOMPARE(finishedSpy.at(6).at(3).toInt(), 25);
+    QCOMPARE(terminatedSpy.count(), 1);
+    QCOMPARE(runs.load(), 5);
+}
+
+void CoreTests::metricsSnapshotCountsTasksAndLatencies() {
+    Core core;
+    QVERIFY(!core.isMetricsEnabled());
+    QCOMPARE(core.metricsSnapshot().total.added, quint64(0));
+
+    core.registerTask(165, []() -> int {
+        QThread::msleep(20);
+        return 0;
+    }, 165);
+    core.addTask(165); // untimed: metrics are still off
+    core.setMetricsEnabled(true);
+    QVERIFY(core.isMetricsEnabled());
+
+    QSignalSpy finishedSpy(&core, &Core::finishedTask);
+    QVERIFY(finishedSpy.isValid());
+    core.addTask(165);
+    core.addTask(165);
+
+    const Core::MetricsSnapshot during = core.metricsSnapshot();
+    QCOMPARE(during.byGroup.value(165).active, 1);
+    QCOMPARE(during.byGroup.value(165).queued, 2);
+
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 3, 2000);
+    const Core::MetricsSnapshot after = core.metricsSnapshot();
+    const Core::TaskMetrics typeMetrics = after.byType.value(165);
+    QCOMPARE(typeMetrics.added, quint64(2));
+    QCOMPARE(typeMetrics.started, quint64(2));
+    QCOMPARE(typeMetrics.finished, quint64(2));
+    QCOMPARE(typeMetrics.queued, 0);
+    QCOMPARE(typeMetrics.runTime.count, quint64(2));
+    QVERIFY(typeMetrics.runTime.meanUs() >= 15000.0);
+    // The second timed task waited behind the first timed one (and the untimed one before it).
+    QVERIFY(typeMetrics.queueWait.maxUs >= 15000);
+    QCOMPARE(after.total.finished, quint64(2));
+
+    core.resetMetrics();
+    QCOMPARE(core.metricsSnapshot().total.finished, quint64(0));
+}
+
+void CoreTests::metricsCountPooledTasksWhenTheyRun() {
+    Core core;
+    QVERIFY(core.setExecutionMode(Core::ExecutionMode::WorkerPool, 1));
+    core.setMetricsEnabled(true);
+    core.registerTask(166, []() -> int {
+        QThread::msleep(20);
+        return 0;
+    }, 166);
+    core.registerTask(167, []() -> int { return 0; }, 167);
+
+    QSignalSpy finishedSpy(&core, &Core::finishedTask);
+    QVERIFY(finishedSpy.isValid());
+    core.addTask(166);
+    core.addTask(167); // own group, so it is pushed at once and waits for the single worker
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 2, 2000);
+    const Core::TaskMetrics waitingMetrics = core.metricsSnapshot().byType.value(167);
+    QCOMPARE(waitingMetrics.started, quint64(1));
+    QVERIFY(waitingMetrics.queueWait.maxUs >= 15000);
+}
+
+void CoreTests::metricsCountBatchedTasks() {
+    Core core;
+    core.setMetricsEnabled(true);
+    core.registerTask(176, [](int value) -> int {
+        QThread::msleep(20);
+        return value;
+    }, 176);
+
+    QSignalSpy finishedSpy(&core, &Core::finishedTask);
+    QVERIFY(finishedSpy.isValid());
+    core.addTasks(176, std::vector<std::tuple<int>>{ std::tuple<int>(1), std::tuple<int>(2), std::tuple<int>(3) });
+    QCOMPARE(core.metricsSnapshot().byType.value(176).added, quint64(3));
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 3, 2000);
+
+    const Core::TaskMetrics typeMetrics = core.metricsSnapshot().byType.value(176);
+    QCOMPARE(typeMetrics.started, quint64(3));
+    QCOMPARE(typeMetrics.finished, quint64(3));
+    QCOMPARE(typeMetrics.queueWait.count, quint64(3));
+    QCOMPARE(typeMetrics.runTime.count, quint64(3));
+    // Group 176 runs one task at a time, so the last task of the batch waited behind two runs.
+    QVERIFY(typeMetrics.queueWait.maxUs >= 30000);
+}
+
+void CoreTests::chromeTraceJsonRecordsQueueWaitsAndRuns() {
+    Core core;
+    QVERIFY(!core.isTracingEnabled());
+    QVERIFY(core.chromeTraceJson().isEmpty());
+
+    core.registerTask(166, []() -> int {
+        QThread::msleep(5);
+        return 0;
+    }, 166);
+    core.setTracingEnabled(true);
+    QVERIFY(core.isTracingEnabled());
+
+    QSignalSpy finishedSpy(&core, &Core::finishedTask);
+    QVERIFY(finishedSpy.isValid());
+    core.addTask(166);
+    core.addTask(166);
+    core.addTasks(166, std::vector<std::tuple<>>{ std::tuple<>(), std::tuple<>() });
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 4, 2000);
+
+    const QByteArray json = core.chromeTraceJson();
+    QVERIFY(json.startsWith("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+    QVERIFY(json.endsWith("]}"));
+    // The batch is traced like single additions. Only the first task started without queueing.
+    QCOMPARE(json.count("\"ph\":\"X\""), 4);
+    QCOMPARE(json.count("\"ph\":\"b\""), 3);
+    QVERIFY(json.contains("\"name\":\"group 166 queue\""));
+    QVERIFY(json.contains("\"name\":\"thread_name\""));
+    QVERIFY(json.contains("\"name\":\"finished\""));
+
+    core.setTracingEnabled(false);
+    QVERIFY(!core.isTracingEnabled());
+}
+
+void CoreTests::deadlinesExpireQueuedTasksAndStopRunningOnes() {
+    Core core;
+    core.registerTask(167, [&core](int value) -> int {
+        for (int i = 0; i < 400; ++i) {
+            if (auto* stop = core.stopTaskFlag(); stop && stop->load()) {
+                return -value;
+            }
+            QThread::msleep(5);
+        }
+        return value;
+    }, 167);
+
+    QSignalSpy startedSpy(&core, &Core::startedTask);
+    QSignalSpy finishedSpy(&core, &Core::finishedTask);
+    QSignalSpy stopRequestedSpy(&core, &Core::stopRequestedTask);
+    QSignalSpy expiredSpy(&core, &Core::expiredTask);
+    QVERIFY(startedSpy.isValid());
+    QVERIFY(finishedSpy.isValid());
+    QVERIFY(stopRequestedSpy.isValid());
+    QVERIFY(expiredSpy.isValid());
+
+    // Already past its deadline: reported right away and never started.
+    core.addTaskWithDeadline(167, QDeadlineTimer(0), 1);
+    QCOMPARE(expiredSpy.count(), 1);
+    QCOMPARE(startedSpy.count(), 0);
+
+    core.addTaskWithDeadline(167, QDeadlineTimer(150), 2); // runs, then gets stopped at its deadline
+    core.addTaskWithDeadline(167, QDeadlineTimer(50), 3);  // expires while queued behind it
+    core.addTask(167, 4);                                  // no deadline: starts after the stopped task
+    QCOMPARE(startedSpy.count(), 1);
+
+    QTRY_COMPARE_WITH_TIMEOUT(expiredSpy.count(), 2, 1000);
+    QCOMPARE(expiredSpy.at(1).at(1).toInt(), 167);
+    QTRY_COMPARE_WITH_TIMEOUT(stopRequestedSpy.count(), 1, 1000);
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 1, 1000);
+    QCOMPARE(finishedSpy.at(0).at(3).toInt(), -2);
+
+    QTRY_COMPARE_WITH_TIMEOUT(startedSpy.count(), 2, 1000);
+    core.stopTasks();
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 2, 1000);
+    QCOMPARE(expiredSpy.count(), 2);
+}
+
+void CoreTests::groupThreadPolicyAppliesToDedicatedThreadsAndGroupWorkers() {
+    Core core;
+    core.registerTask(168, [&core]() -> QString {
+        for (int i = 0; i < 400; ++i) {
+            if (auto* stop = core.stopTaskFlag(); stop && stop->load()) {
+                break;
+            }
+            QThread::msleep(1);
+        }
+        return QThread::currentThread()->objectName();
+    }, 168);
+
+    TaskThreadPolicy policy;
+    policy.threadName = QStringLiteral("core-168");
+    policy.stackSize = 1024 * 1024;
+    policy.priority = QThread::LowPriority;
+    QVERIFY(core.setGroupThreadPolicy(168, policy));
+    QCOMPARE(core.groupThreadPolicy(168).threadName, QStringLiteral("core-168"));
+
+    TaskThreadPolicy missingNode;
+    missingNode.numaNode = 4096;
+    QVERIFY(!core.setGroupThreadPolicy(168, missingNode));
+    QCOMPARE(core.groupThreadPolicy(168).threadName, QStringLiteral("core-168")); // left unchanged
+
+    QSignalSpy finishedSpy(&core, &Core::finishedTask);
+    QVERIFY(finishedSpy.isValid());
+    core.addTask(168);
+    QVERIFY(!core.setGroupThreadPolicy(168, TaskThreadPolicy())); // the group has an active task
+    core.stopTaskByGroup(168);
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 1, 2000);
+    QCOMPARE(finishedSpy.at(0).at(3).toString(), QStringLiteral("core-168"));
+
+    // In WorkerPool mode the group gets workers of its own, named by the policy.
+    policy.dedicatedWorkers = 1;
+    QVERIFY(core.setGroupThreadPolicy(168, policy));
+    QVERIFY(core.setExecutionMode(Core::ExecutionMode::WorkerPool, 2));
+    core.addTask(168);
+    core.stopTaskByGroup(168);
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 2, 2000);
+    QCOMPARE(finishedSpy.at(1).at(3).toString(), QStringLiteral("core-168"));
+
+    QVERIFY(core.setGroupThreadPolicy(168, TaskThreadPolicy()));
+    QVERIFY(core.groupThreadPolicy(168).isDefault());
+}
+
+void CoreTests::cancellationTokenStopsWholeSubtree() {
+    Core core;
+    core.registerTask(169, [&core](int value) -> int {
+        // Read once and polled, like the example tasks: cancel() must set this very flag.
+        std::atomic_bool* stop = core.stopTaskFlag();
+        for (int i = 0; i < 400; ++i) {
+            if (stop && stop->load()) {
+                return -value;
+            }
+            QThread::msleep(5);
+        }
+        return value;
+    }, 169);
+    core.setGroupConcurrency(169, 2);
+
+    TaskCancellationToken request;
+    const TaskCancellationToken child = request.createChild();
+    const TaskCancellationToken grandchild = child.createChild();
+    TaskCancellationToken unrelated;
+
+    QSignalSpy startedSpy(&core, &Core::startedTask);
+    QSignalSpy finishedSpy(&core, &Core::finishedTask);
+    QSignalSpy terminatedSpy(&core, &Core::terminatedTask);
+    QVERIFY(startedSpy.isValid());
+    QVERIFY(finishedSpy.isValid());
+    QVERIFY(terminatedSpy.isValid());
+
+    core.addTaskWithToken(child, 169, 1);
+    core.addTaskWithToken(grandchild, 169, 2);
+    core.addTaskWithToken(grandchild, 169, 3); // queued: dropped without starting
+    core.addTaskWithToken(unrelated, 169, 4);  // queued: starts once a slot frees up
+    QCOMPARE(startedSpy.count(), 2);
+
+    request.cancel();
+    QVERIFY(grandchild.isCanceled());
+    QVERIFY(!unrelated.isCanceled());
+
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 2, 1000);
+    QCOMPARE(finishedSpy.at(0).at(3).toInt() + finishedSpy.at(1).at(3).toInt(), -3);
+    QTRY_COMPARE_WITH_TIMEOUT(terminatedSpy.count(), 1, 1000);
+    QTRY_COMPARE_WITH_TIMEOUT(startedSpy.count(), 3, 1000);
+
+    // The independent token was untouched by the cancel above.
+    unrelated.cancel();
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 3, 1000);
+    QCOMPARE(finishedSpy.at(2).at(3).toInt(), -4);
+    QCOMPARE(terminatedSpy.count(), 1);
+}
+
+void CoreTests::adaptivePoolCompensatesBlockedWorkersAndRetiresIdleOnes() {
+    Core core;
+    std::atomic_bool release{false};
+    std::atomic_int running{0};
+    core.registerTask(170, [&release, &running]() -> int {
+        running.fetch_add(1);
+        TaskBlockingRegion blockingRegion;
+        while (!release.load()) {
+            QThread::msleep(1);
+        }
+        return 1;
+    }, 170);
+    core.setGroupConcurrency(170, 2);
+
+    QVERIFY(!core.setAdaptiveWorkerPool(2, 1));
+    QVERIFY(core.setAdaptiveWorkerPool(1, 4, 50));
+    QCOMPARE(core.executionMode(), Core::ExecutionMode::WorkerPool);
+    QCOMPARE(core.workerCount(), 1);
+
+    QSignalSpy finishedSpy(&core, &Core::finishedTask);
+    QVERIFY(finishedSpy.isValid());
+    core.addTask(170);
+    core.addTask(170);
+    // The only worker blocks in the first task, so a compensating worker picks up the second.
+    QTRY_COMPARE_WITH_TIMEOUT(running.load(), 2, 2000);
+    QVERIFY(core.workerCount() >= 2);
+    QVERIFY(core.workerCount() <= 4);
+
+    release.store(true);
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 2, 2000);
+    // Workers above the minimum exit once idle for the timeout.
+    QTRY_COMPARE_WITH_TIMEOUT(core.workerCount(), 1, 2000);
+}
+
+void CoreTests::staticTasksDispatchDirectlyAndShareTheRuntimeRegistry() {
+    Core core;
+    core.registerStaticTasks<ScaleTask, CountTask>();
+    QVERIFY(core.isTaskRegistered(171));
+    bool ok = false;
+    QCOMPARE(core.groupByTask(172, &ok), 172);
+    QVERIFY(ok);
+
+    QSignalSpy finishedSpy(&core, &Core::finishedTask);
+    QVERIFY(finishedSpy.isValid());
+    std::atomic_int counter{0};
+    core.addTask<ScaleTask>(21, 2); // 2 converts to the declared double parameter
+    core.addTask<CountTask>(&counter);
+    core.addTask(171, 5, 3.0);      // the runtime form reaches the same function
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 3, 2000);
+    QCOMPARE(counter.load(), 1);
+
+    QList<int> scaled;
+    for (const auto& event : std::as_const(finishedSpy)) {
+        if (event.at(1).toInt() == 171) {
+            scaled.append(event.at(3).toInt());
+        }
+    }
+    QCOMPARE(scaled, QList<int>({42, 15}));
+
+    // A runtime registration under the same id is not the static definition.
+    QVERIFY(core.unregisterTask(171));
+    core.registerTask(171, [](int value, double) -> int { return value; });
+    bool threw = false;
+    try {
+        core.addTask<ScaleTask>(1, 1.0);
+    } catch (const std::logic_error&) {
+        threw = true;
+    }
+    QVERIFY(threw);
+
+    // Clashing ids reject the whole list.
+    threw = false;
+    try {
+        core.registerStaticTasks<StaticTask<173, &countStaticTask>, ScaleTask>();
+    } catch (const std::logic_error&) {
+        threw = true;
+    }
+    QVERIFY(threw);
+    QVERIFY(!core.isTaskRegistered(173));
+}
+
+void CoreTests::groupRateLimitHoldsTasksInTheQueue() {
+    Core core;
+    core.registerTask(174, [](int value) -> int {
+        return value;
+    }, 174);
+    core.setGroupConcurrency(174, kUnlimitedGroupConcurrency);
+
+    QVERIFY(!core.setGroupRateLimit(174, -1.0));
+    QVERIFY(!core.setGroupRateLimit(174, 10.0, 0));
+    QVERIFY(core.setGroupRateLimit(174, 10.0, 1));
+    QCOMPARE(core.groupRateLimit(174), 10.0);
+    QCOMPARE(core.groupRateBurst(174), 1);
+
+    QSignalSpy finishedSpy(&core, &Core::finishedTask);
+    QVERIFY(finishedSpy.isValid());
+    QElapsedTimer elapsed;
+    elapsed.start();
+    for (int i = 0; i < 3; ++i) {
+        core.addTask(174, i);
+    }
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 1, 2000);
+
+    // The rest wait for tokens in the queue, not on a thread.
+    bool isActive = true;
+    QVERIFY(core.isTaskAddedByGroup(174, &isActive));
+    QVERIFY(!isActive);
+
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 3, 2000);
+    QVERIFY(elapsed.elapsed() >= 150); // two more tokens at 10 per second
+    for (int i = 0; i < 3; ++i) {
+        QCOMPARE(finishedSpy.at(i).at(3).toInt(), i);
+    }
+
+    QVERIFY(core.setGroupRateLimit(174, kUnlimitedGroupRate));
+    QCOMPARE(core.groupRateLimit(174), kUnlimitedGroupRate);
+}
+
+void CoreTests::groupQueueSpillKeepsOverflowOnDiskAndResumesIt() {
+    QTemporaryDir spillDir;
+    QVERIFY(spillDir.isValid());
+    const QString spillPath = spillDir.filePath(QStringLiteral("group175.spill"));
+    std::atomic_bool release{false};
+
+    {
+        Core core;
+        core.registerTask(175, [&core, &release](int value) -> int {
+            while (!release.load()) {
+                if (auto* stop = core.stopTaskFlag(); stop && stop->load()) {
+                    break;
+                }
+                QThread::msleep(1);
+            }
+            return value;
+        }, 175);
+        QVERIFY(core.setGroupQueueSpill(175, 2, spillPath));
+
+        QSignalSpy finishedSpy(&core, &Core::finishedTask);
+        QVERIFY(finishedSpy.isValid());
+        for (int i = 0; i < 10; ++i) {
+            core.addTask(175, i);
+        }
+        // One runs, two wait in memory and the rest wait on disk.
+        QCOMPARE(core.spilledTaskCount(175), qint64(7));
+        QVERIFY(core.isTaskAddedByGroup(175));
+
+        release.store(true);
+        QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 10, 5000);
+        for (int i = 0; i < 10; ++i) {
+            QCOMPARE(finishedSpy.at(i).at(3).toInt(), i);
+        }
+        QCOMPARE(core.spilledTaskCount(175), qint64(0));
+
+        // Leave three tasks on disk when this Core goes away.
+        release.store(false);
+        for (int i = 0; i < 6; ++i) {
+            core.addTask(175, 100 + i);
+        }
+        QCOMPARE(core.spilledTaskCount(175), qint64(3));
+    }
+
+    release.store(true);
+    Core core;
+    core.registerTask(175, [](int value) -> int {
+        return value;
+    }, 175);
+    QSignalSpy finishedSpy(&core, &Core::finishedTask);
+    QVERIFY(finishedSpy.isValid());
+    QVERIFY(core.setGroupQueueSpill(175, 2, spillPath));
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 3, 5000);
+    for (int i = 0; i < 3; ++i) {
+        QCOMPARE(finishedSpy.at(i).at(3).toInt(), 103 + i);
+    }
+    QCOMPARE(core.spilledTaskCount(175), qint64(0));
+    QVERIFY(core.setGroupQueueSpill(175, 0, QString()));
+}
+
+void CoreTests::stopAllTasksDropsSpilledBacklog() {
+    QTemporaryDir spillDir;
+    QVERIFY(spillDir.isValid());
+    Core core;
+    core.setMetricsEnabled(true);
+    core.registerTask(176, [&core](int value) -> int {
+        while (auto* stop = core.stopTaskFlag()) {
+            if (stop->load()) {
+                break;
+            }
+            QThread::msleep(1);
+        }
+        return value;
+    }, 176);
+    QVERIFY(core.setGroupQueueSpill(176, 2, spillDir.filePath(QStringLiteral("group176.spill"))));
+    for (int i = 0; i < 8; ++i) {
+        core.addTask(176, i);
+    }
+    QCOMPARE(core.spilledTaskCount(176), qint64(5));
+    QCOMPARE(core.metricsSnapshot().total.queued, 7);
+
+    core.stopAllTasks();
+    QCOMPARE(core.spilledTaskCount(176), qint64(0));
+    QCOMPARE(core.metricsSnapshot().total.queued, 0);
+    QCOMPARE(core.metricsSnapshot().byType.value(176).dropped, quint64(7));
+    QTRY_VERIFY_WITH_TIMEOUT(!core.isTaskAddedByGroup(176), 2000);
+    QCOMPARE(core.metricsSnapshot().total.queued, 0);
+}
+
 QTEST_MAIN(CoreTests)
 #include "core_tests.moc"
 